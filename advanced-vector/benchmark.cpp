@@ -0,0 +1,383 @@
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Предельный объём памяти под элементы одного контейнера. Для крупных типов
+// максимальный размер контейнера меньше 10^8 элементов
+#ifndef VECTOR_BENCHMARK_MAX_BYTES
+#define VECTOR_BENCHMARK_MAX_BYTES (512u << 20)
+#endif
+
+namespace {
+
+std::atomic<bool> count_allocations{false};
+std::atomic<size_t> num_allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// Заменённый operator new выделяет память через malloc, поэтому её освобождает free.
+// GCC видит только пару operator new/free и считает её несогласованной
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+#pragma GCC diagnostic pop
+
+namespace {
+
+const size_t MAX_ELEMENTS = 100'000'000;
+
+struct Pod64 {
+    int64_t values[8];
+};
+
+// Тип, перемещающий конструктор которого может бросить исключение: при реаллокации
+// контейнеры вынуждены копировать такие элементы
+struct ThrowingMove {
+    ThrowingMove() = default;
+    explicit ThrowingMove(int64_t id)
+        : id(id)
+        , name("throwing move payload") {
+    }
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : id(other.id)
+        , name(std::move(other.name)) {
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&&) noexcept(false) = default;
+
+    int64_t id = 0;
+    std::string name;
+};
+
+template <typename T>
+T MakeValue(int64_t i);
+
+template <>
+int MakeValue<int>(int64_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+Pod64 MakeValue<Pod64>(int64_t i) {
+    return Pod64{{i}};
+}
+
+template <>
+std::string MakeValue<std::string>(int64_t i) {
+    // Строка длиннее буфера SSO, чтобы копирование выделяло память
+    return "benchmark string #" + std::to_string(i);
+}
+
+template <>
+ThrowingMove MakeValue<ThrowingMove>(int64_t i) {
+    return ThrowingMove{i};
+}
+
+int64_t Weight(int value) {
+    return value;
+}
+
+int64_t Weight(const Pod64& value) {
+    return value.values[0];
+}
+
+int64_t Weight(const std::string& value) {
+    return static_cast<int64_t>(value.size());
+}
+
+int64_t Weight(const ThrowingMove& value) {
+    return value.id;
+}
+
+// Единый интерфейс std::vector и Vector для шаблонных бенчмарков
+
+template <typename T>
+void PushBack(std::vector<T>& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T>
+void PushBack(Vector<T>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T>
+void EmplaceBack(std::vector<T>& v, T&& value) {
+    v.emplace_back(std::move(value));
+}
+
+template <typename T>
+void EmplaceBack(Vector<T>& v, T&& value) {
+    v.EmplaceBack(std::move(value));
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void PopBack(std::vector<T>& v) {
+    v.pop_back();
+}
+
+template <typename T>
+void PopBack(Vector<T>& v) {
+    v.PopBack();
+}
+
+template <typename T>
+void InsertMiddle(std::vector<T>& v, const T& value) {
+    v.insert(v.begin() + v.size() / 2, value);
+}
+
+template <typename T>
+void InsertMiddle(Vector<T>& v, const T& value) {
+    v.Insert(v.begin() + v.Size() / 2, value);
+}
+
+template <typename T>
+void EraseMiddle(std::vector<T>& v) {
+    v.erase(v.begin() + v.size() / 2);
+}
+
+template <typename T>
+void EraseMiddle(Vector<T>& v) {
+    v.Erase(v.begin() + v.Size() / 2);
+}
+
+template <typename Container>
+Container MakeFilled(size_t size) {
+    using T = typename Container::value_type;
+    Container result;
+    Reserve(result, size);
+    for (size_t i = 0; i < size; ++i) {
+        EmplaceBack(result, MakeValue<T>(static_cast<int64_t>(i)));
+    }
+    return result;
+}
+
+// Останавливает таймер вместе с подсчётом выделений памяти
+void Pause(benchmark::State& state) {
+    state.PauseTiming();
+    count_allocations = false;
+}
+
+void Resume(benchmark::State& state) {
+    count_allocations = true;
+    state.ResumeTiming();
+}
+
+// Включает подсчёт выделений памяти на время измерения и по его завершении публикует
+// счётчик allocs/op: среднее число выделений на одну операцию контейнера
+class AllocationReport {
+public:
+    AllocationReport(benchmark::State& state, size_t ops_per_iteration)
+        : state_(state)
+        , ops_per_iteration_(ops_per_iteration) {
+        num_allocations = 0;
+        count_allocations = true;
+    }
+
+    AllocationReport(const AllocationReport&) = delete;
+    AllocationReport& operator=(const AllocationReport&) = delete;
+
+    ~AllocationReport() {
+        count_allocations = false;
+        const double ops = static_cast<double>(ops_per_iteration_);
+        state_.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(num_allocations.load()) / ops, benchmark::Counter::kAvgIterations);
+        state_.SetItemsProcessed(state_.iterations() * static_cast<int64_t>(ops_per_iteration_));
+    }
+
+private:
+    benchmark::State& state_;
+    size_t ops_per_iteration_;
+};
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t size = static_cast<size_t>(state.range(0));
+    const T value = MakeValue<T>(1);
+    AllocationReport report(state, size);
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < size; ++i) {
+            PushBack(v, value);
+        }
+        benchmark::DoNotOptimize(v);
+        Pause(state);
+        v = Container();
+        Resume(state);
+    }
+}
+
+template <typename Container>
+void BM_EmplaceBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t size = static_cast<size_t>(state.range(0));
+    AllocationReport report(state, size);
+    for (auto _ : state) {
+        Container v;
+        for (size_t i = 0; i < size; ++i) {
+            EmplaceBack(v, MakeValue<T>(static_cast<int64_t>(i)));
+        }
+        benchmark::DoNotOptimize(v);
+        Pause(state);
+        v = Container();
+        Resume(state);
+    }
+}
+
+// Реаллокация заполненного контейнера
+template <typename Container>
+void BM_Reserve(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    AllocationReport report(state, 1);
+    for (auto _ : state) {
+        Pause(state);
+        Container v = MakeFilled<Container>(size);
+        Resume(state);
+        Reserve(v, size * 2);
+        benchmark::DoNotOptimize(v);
+        Pause(state);
+        v = Container();
+        Resume(state);
+    }
+}
+
+// Вставка в середину контейнера из size элементов. PopBack возвращает прежний размер,
+// не меняя вместимости
+template <typename Container>
+void BM_InsertMiddle(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t size = static_cast<size_t>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    Reserve(v, size + 1);
+    const T value = MakeValue<T>(-1);
+    AllocationReport report(state, 1);
+    for (auto _ : state) {
+        InsertMiddle(v, value);
+        PopBack(v);
+        benchmark::ClobberMemory();
+    }
+}
+
+template <typename Container>
+void BM_EraseMiddle(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t size = static_cast<size_t>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    const T value = MakeValue<T>(-1);
+    AllocationReport report(state, 1);
+    for (auto _ : state) {
+        EraseMiddle(v);
+        PushBack(v, value);
+        benchmark::ClobberMemory();
+    }
+}
+
+template <typename Container>
+void BM_CopyAssign(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const Container source = MakeFilled<Container>(size);
+    AllocationReport report(state, 1);
+    for (auto _ : state) {
+        Container target;
+        target = source;
+        benchmark::DoNotOptimize(target);
+        Pause(state);
+        target = Container();
+        Resume(state);
+    }
+}
+
+template <typename Container>
+void BM_MoveAssign(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    Container first = MakeFilled<Container>(size);
+    Container second;
+    AllocationReport report(state, 2);
+    for (auto _ : state) {
+        second = std::move(first);
+        first = std::move(second);
+        benchmark::DoNotOptimize(first);
+    }
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    const Container v = MakeFilled<Container>(size);
+    AllocationReport report(state, size);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& item : v) {
+            sum += Weight(item);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+template <typename T>
+int64_t MaxSize() {
+    return static_cast<int64_t>(std::min<size_t>(MAX_ELEMENTS, VECTOR_BENCHMARK_MAX_BYTES / sizeof(T)));
+}
+
+template <typename T>
+void Sizes(benchmark::internal::Benchmark* benchmark) {
+    benchmark->RangeMultiplier(10)->Range(8, MaxSize<T>())->Unit(benchmark::kMicrosecond);
+}
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(name, T)                                     \
+    BENCHMARK_TEMPLATE(name, std::vector<T>)->Apply(Sizes<T>);     \
+    BENCHMARK_TEMPLATE(name, Vector<T>)->Apply(Sizes<T>)
+
+#define VECTOR_BENCHMARKS(T)                  \
+    VECTOR_BENCHMARK(BM_PushBack, T);         \
+    VECTOR_BENCHMARK(BM_EmplaceBack, T);      \
+    VECTOR_BENCHMARK(BM_Reserve, T);          \
+    VECTOR_BENCHMARK(BM_InsertMiddle, T);     \
+    VECTOR_BENCHMARK(BM_EraseMiddle, T);      \
+    VECTOR_BENCHMARK(BM_CopyAssign, T);       \
+    VECTOR_BENCHMARK(BM_MoveAssign, T);       \
+    VECTOR_BENCHMARK(BM_Iterate, T)
+
+VECTOR_BENCHMARKS(int);
+VECTOR_BENCHMARKS(Pod64);
+VECTOR_BENCHMARKS(std::string);
+VECTOR_BENCHMARKS(ThrowingMove);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,161 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <bit>
+#include <limits>
+
+// Вектор, в который несколько потоков могут одновременно добавлять элементы без
+// блокировок. Элементы хранятся в сегментах RawMemory, вместимость которых удваивается
+// от сегмента к сегменту, поэтому элементы никогда не перемещаются: ссылки на них
+// остаются действительными до разрушения вектора.
+// EmplaceBack занимает ячейку одним атомарным инкрементом и не ждёт других потоков.
+// Новый сегмент выделяет поток, первым до него добравшийся, а проигравшие гонку
+// за установку сегмента освобождают свои копии.
+// Читать элемент можно только после того, как добавивший его EmplaceBack завершился
+// (например, по ссылке, полученной от EmplaceBack, или после join потоков)
+template <typename T>
+class ConcurrentVector {
+public:
+    using value_type = T;
+
+    ConcurrentVector() = default;
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Разрушение не должно выполняться одновременно с добавлением элементов
+    ~ConcurrentVector() {
+        for (auto& slot : segments_) {
+            Segment* segment = slot.load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                // Сегменты устанавливаются не по порядку, дальше могут быть и другие
+                continue;
+            }
+            for (size_t i = 0; i < segment->items.Capacity(); ++i) {
+                if (segment->ready[i].load(std::memory_order_relaxed)) {
+                    std::destroy_at(segment->items + i);
+                }
+            }
+            delete segment;
+        }
+    }
+
+    // Заранее выделяет сегменты под capacity элементов. Можно вызывать параллельно с EmplaceBack
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        const size_t last_segment = SegmentIndex(capacity - 1);
+        for (size_t i = 0; i <= last_segment; ++i) {
+            GetSegment(i);
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Добавляет элемент и возвращает ссылку на него. Если конструктор элемента бросит
+    // исключение, занятая ячейка остаётся пустой и не попадает в Snapshot
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const size_t segment_index = SegmentIndex(index);
+        Segment& segment = GetSegment(segment_index);
+        const size_t offset = index - SegmentBegin(segment_index);
+        T* item = new (segment.items + offset) T(std::forward<Args>(args)...);
+        segment.ready[offset].store(true, std::memory_order_release);
+        return *item;
+    }
+
+    // Число занятых ячеек, включая элементы, которые ещё конструируются
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        const size_t segment_index = SegmentIndex(index);
+        Segment* segment = segments_[segment_index].load(std::memory_order_acquire);
+        assert(segment != nullptr);
+        return segment->items[index - SegmentBegin(segment_index)];
+    }
+
+    // Копирует элементы в непрерывный вектор в порядке их индексов. В копию попадают все
+    // элементы, добавление которых завершилось до вызова. Элементы, добавляемые
+    // одновременно с вызовом, могут как попасть, так и не попасть в копию
+    Vector<T> Snapshot() const {
+        const size_t size = Size();
+        Vector<T> result;
+        result.Reserve(size);
+        for (size_t segment_index = 0; segment_index < MAX_SEGMENTS; ++segment_index) {
+            const size_t begin = SegmentBegin(segment_index);
+            if (begin >= size) {
+                break;
+            }
+            const Segment* segment = segments_[segment_index].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            const size_t count = std::min(segment->items.Capacity(), size - begin);
+            for (size_t i = 0; i < count; ++i) {
+                if (segment->ready[i].load(std::memory_order_acquire)) {
+                    result.PushBack(segment->items[i]);
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    // Вместимость первого сегмента. Сегмент k вмещает FIRST_SEGMENT_SIZE << k элементов
+    static constexpr size_t FIRST_SEGMENT_SIZE = 64;
+    static constexpr size_t MAX_SEGMENTS =
+        std::numeric_limits<size_t>::digits - std::countr_zero(FIRST_SEGMENT_SIZE);
+
+    // Память под элементы сегмента и флаги готовности его элементов
+    struct Segment {
+        explicit Segment(size_t capacity)
+            : items(capacity)
+            , ready(std::make_unique<std::atomic<bool>[]>(capacity)) {
+        }
+
+        RawMemory<T> items;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+    static size_t SegmentIndex(size_t index) noexcept {
+        return static_cast<size_t>(std::bit_width(index / FIRST_SEGMENT_SIZE + 1)) - 1;
+    }
+
+    // Индекс первого элемента сегмента
+    static size_t SegmentBegin(size_t segment_index) noexcept {
+        return FIRST_SEGMENT_SIZE * ((size_t{1} << segment_index) - 1);
+    }
+
+    Segment& GetSegment(size_t segment_index) {
+        std::atomic<Segment*>& slot = segments_[segment_index];
+        Segment* segment = slot.load(std::memory_order_acquire);
+        if (segment != nullptr) {
+            return *segment;
+        }
+        auto candidate = std::make_unique<Segment>(FIRST_SEGMENT_SIZE << segment_index);
+        if (slot.compare_exchange_strong(segment, candidate.get(), std::memory_order_acq_rel)) {
+            return *candidate.release();
+        }
+        // Сегмент успел установить другой поток
+        return *segment;
+    }
+
+    std::atomic<Segment*> segments_[MAX_SEGMENTS]{};
+    std::atomic<size_t> size_{0};
+};
@@ -0,0 +1,552 @@
+#pragma once
+#include "vector.h"
+
+#include <bit>
+#include <functional>
+
+// Упорядоченные ассоциативные контейнеры FlatSet и FlatMap поверх Vector. Элементы хранятся
+// в одном буфере, отсортированными по ключу, поэтому поиск не переходит по узлам дерева,
+// как std::map, а проходит по непрерывной памяти. Вставка одного элемента стоит O(n), и
+// наполнять контейнер стоит пакетами через InsertSorted, Insert(first, last) и Merge: они
+// добавляют весь пакет одной вставкой диапазона (не более одного перевыделения) и сливают
+// его с имеющимися элементами за O(n + m).
+// Способ поиска задаётся политикой: BranchlessSearch (по умолчанию) или EytzingerSearch
+
+// Двоичный поиск без ветвлений по отсортированным элементам: на каждом шаге граница
+// сдвигается условной пересылкой, и предсказатель переходов не ошибается на случайных ключах
+struct BranchlessSearch {
+    template <typename K>
+    class Index {
+    public:
+        template <typename Value, typename KeyOf>
+        void Rebuild(const Value*, size_t, KeyOf) {
+        }
+
+        // Индекс первого элемента, ключ которого не меньше key
+        template <typename Value, typename KeyOf, typename Key, typename Compare>
+        size_t LowerBound(const Value* items, size_t size, KeyOf key_of, const Key& key,
+                const Compare& comp) const {
+            if (size == 0) {
+                return 0;
+            }
+            const Value* base = items;
+            while (size > 1) {
+                const size_t half = size / 2;
+                base = comp(key_of(base[half]), key) ? base + half : base;
+                size -= half;
+            }
+            return static_cast<size_t>(base - items) + static_cast<size_t>(comp(key_of(*base), key));
+        }
+    };
+};
+
+// Поиск по копии ключей, разложенной в порядке Эйтцингера (уровни неявного двоичного
+// дерева подряд, как в двоичной куче). Первые уровни, общие для всех поисков, остаются
+// в кэше, а потомки узла на несколько уровней вниз лежат рядом и подгружаются заранее.
+// Ключи хранятся отдельно от значений, что выгодно для FlatMap с крупными значениями.
+// Индекс перестраивается за O(n) при каждом изменении, поэтому политика подходит
+// для контейнеров, которые читаются намного чаще, чем изменяются
+struct EytzingerSearch {
+    template <typename K>
+    class Index {
+        // Узлы на четыре уровня ниже текущего занимают 16 соседних ячеек
+        static constexpr size_t PREFETCH_STRIDE = 16;
+
+    public:
+        template <typename Value, typename KeyOf>
+        void Rebuild(const Value* items, size_t size, KeyOf key_of) {
+            ranks_.Resize(size);
+            FillRanks(ranks_.GetAddress(), size, 1, 0);
+            keys_.Clear();
+            keys_.Reserve(size);
+            for (size_t i = 0; i < size; ++i) {
+                keys_.PushBack(key_of(items[ranks_[i]]));
+            }
+        }
+
+        template <typename Value, typename KeyOf, typename Key, typename Compare>
+        size_t LowerBound(const Value*, size_t size, KeyOf, const Key& key, const Compare& comp) const {
+            const K* keys = keys_.GetAddress();
+            // Узел k хранится в ячейке k - 1, потомки узла k — узлы 2k и 2k + 1
+            size_t k = 1;
+            while (k <= size) {
+                if (const size_t ahead = k * PREFETCH_STRIDE; ahead <= size) {
+                    __builtin_prefetch(keys + ahead - 1);
+                }
+                k = 2 * k + static_cast<size_t>(comp(keys[k - 1], key));
+            }
+            // Младшие единичные биты — повороты вправо после последнего узла с ключом не меньше key
+            k >>= std::countr_one(k) + 1;
+            return k == 0 ? size : ranks_[k - 1];
+        }
+
+    private:
+        Vector<K> keys_;
+        // Позиция ключа узла в отсортированном массиве
+        Vector<size_t> ranks_;
+
+        // Нумерует узлы поддерева node в порядке обхода, начиная с next
+        static size_t FillRanks(size_t* ranks, size_t size, size_t node, size_t next) noexcept {
+            if (node > size) {
+                return next;
+            }
+            next = FillRanks(ranks, size, 2 * node, next);
+            ranks[node - 1] = next++;
+            return FillRanks(ranks, size, 2 * node + 1, next);
+        }
+    };
+};
+
+namespace flat_map_detail {
+
+// Итератор FlatMap по вектору Items пар std::pair<K, V>. Ключ через итератор доступен
+// только для чтения: присваивание ключу нарушило бы порядок элементов. Как и у std::flat_map,
+// разыменование возвращает пару ссылок на ключ и значение, а не ссылку на хранимую пару
+template <typename Items, bool IsConst>
+class PairIterator {
+    using Base = std::conditional_t<IsConst, typename Items::const_iterator, typename Items::iterator>;
+    using Pair = typename Items::value_type;
+    using Mapped = std::conditional_t<IsConst, const typename Pair::second_type, typename Pair::second_type>;
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    // Разыменование даёт не ссылку на value_type, поэтому для старых алгоритмов это итератор ввода
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Pair;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const typename Pair::first_type&, Mapped&>;
+
+    // Обёртка над парой ссылок для operator->
+    class pointer {
+    public:
+        explicit pointer(reference ref) noexcept
+            : ref_(ref) {
+        }
+
+        reference* operator->() noexcept {
+            return &ref_;
+        }
+
+    private:
+        reference ref_;
+    };
+
+    PairIterator() = default;
+
+    explicit PairIterator(Base it) noexcept
+        : it_(it) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    PairIterator(const PairIterator<Items, OtherConst>& other) noexcept
+        : it_(other.it_) {
+    }
+
+    reference operator*() const noexcept {
+        return reference(it_->first, it_->second);
+    }
+    pointer operator->() const noexcept {
+        return pointer(**this);
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    PairIterator& operator++() noexcept {
+        ++it_;
+        return *this;
+    }
+    PairIterator operator++(int) noexcept {
+        PairIterator old = *this;
+        ++it_;
+        return old;
+    }
+    PairIterator& operator--() noexcept {
+        --it_;
+        return *this;
+    }
+    PairIterator operator--(int) noexcept {
+        PairIterator old = *this;
+        --it_;
+        return old;
+    }
+    PairIterator& operator+=(difference_type offset) noexcept {
+        it_ += offset;
+        return *this;
+    }
+    PairIterator& operator-=(difference_type offset) noexcept {
+        it_ -= offset;
+        return *this;
+    }
+
+    friend PairIterator operator+(PairIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+    friend PairIterator operator+(difference_type offset, PairIterator it) noexcept {
+        return it += offset;
+    }
+    friend PairIterator operator-(PairIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+    friend difference_type operator-(const PairIterator& lhs, const PairIterator& rhs) noexcept {
+        return lhs.it_ - rhs.it_;
+    }
+
+    friend bool operator==(const PairIterator& lhs, const PairIterator& rhs) noexcept {
+        return lhs.it_ == rhs.it_;
+    }
+    friend auto operator<=>(const PairIterator& lhs, const PairIterator& rhs) noexcept {
+        return lhs.it_ <=> rhs.it_;
+    }
+
+private:
+    friend class PairIterator<Items, !IsConst>;
+
+    Base it_{};
+};
+
+// Общая часть FlatSet и FlatMap: отсортированный по ключу вектор элементов Value
+// с уникальными ключами K, которые извлекает KeyOf. KeyOf задаёт и итераторы: через них
+// ключи элементов менять нельзя
+template <typename K, typename Value, typename KeyOf, typename Compare, typename SearchPolicy>
+class FlatTree {
+    using Items = Vector<Value>;
+
+public:
+    using key_type = K;
+    using value_type = Value;
+    using key_compare = Compare;
+    using iterator = typename KeyOf::template Iterator<Items, false>;
+    using const_iterator = typename KeyOf::template Iterator<Items, true>;
+
+    FlatTree() = default;
+
+    explicit FlatTree(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    FlatTree(std::initializer_list<Value> items, const Compare& comp = Compare())
+        : comp_(comp) {
+        Insert(items.begin(), items.end());
+    }
+
+    size_t Size() const noexcept {
+        return items_.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return items_.Capacity();
+    }
+
+    void Reserve(size_t capacity) {
+        items_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+        RebuildIndex();
+    }
+
+    void Swap(FlatTree& other) noexcept {
+        items_.Swap(other.items_);
+        std::swap(index_, other.index_);
+        std::swap(comp_, other.comp_);
+    }
+
+    // Отсортированные элементы
+    const Value* GetAddress() const noexcept {
+        return items_.GetAddress();
+    }
+
+    iterator begin() noexcept {
+        return MakeIterator(0);
+    }
+    iterator end() noexcept {
+        return MakeIterator(items_.Size());
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return MakeIterator(0);
+    }
+    const_iterator cend() const noexcept {
+        return MakeIterator(items_.Size());
+    }
+
+    // Первый элемент с ключом не меньше key
+    iterator LowerBound(const K& key) noexcept {
+        return MakeIterator(LowerBoundIndex(key));
+    }
+    const_iterator LowerBound(const K& key) const noexcept {
+        return MakeIterator(LowerBoundIndex(key));
+    }
+
+    iterator Find(const K& key) noexcept {
+        return MakeIterator(FindIndex(key));
+    }
+    const_iterator Find(const K& key) const noexcept {
+        return MakeIterator(FindIndex(key));
+    }
+
+    bool Contains(const K& key) const noexcept {
+        return FindIndex(key) != items_.Size();
+    }
+
+    // Вставляет элемент, если элемента с таким ключом ещё нет. Возвращает позицию
+    // элемента с ключом и признак вставки. Стоит O(n): для наполнения используйте InsertSorted
+    std::pair<iterator, bool> Insert(const Value& value) {
+        return EmplaceUnique(value);
+    }
+    std::pair<iterator, bool> Insert(Value&& value) {
+        return EmplaceUnique(std::move(value));
+    }
+
+    // Добавляет элементы [first, last), отсортированные по ключу. Из элементов с равными
+    // ключами остаётся первый, а элементы с уже имеющимися ключами не вставляются
+    template <std::input_iterator InputIt>
+    void InsertSorted(InputIt first, InputIt last) {
+        const size_t old_size = items_.Size();
+        AppendBatch(old_size, [&] {
+            items_.Insert(items_.end(), first, last);
+        });
+        MergeAppended(old_size);
+    }
+
+    // Как InsertSorted, но элементы [first, last) могут быть не упорядочены:
+    // перед слиянием добавленная часть сортируется
+    template <std::input_iterator InputIt>
+    void Insert(InputIt first, InputIt last) {
+        const size_t old_size = items_.Size();
+        AppendBatch(old_size, [&] {
+            items_.Insert(items_.end(), first, last);
+            std::stable_sort(items_.begin() + old_size, items_.end(), ValueLess());
+        });
+        MergeAppended(old_size);
+    }
+
+    // Добавляет элементы other с отсутствующими в контейнере ключами
+    void Merge(const FlatTree& other) {
+        // Слияние с собой ничего не добавляет, а вставка собственных элементов недопустима
+        if (&other == this) {
+            return;
+        }
+        InsertSorted(other.items_.begin(), other.items_.end());
+    }
+
+    void Merge(FlatTree&& other) {
+        if (&other == this) {
+            return;
+        }
+        InsertSorted(std::make_move_iterator(other.items_.begin()), std::make_move_iterator(other.items_.end()));
+        other.Clear();
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        items_.Erase(items_.cbegin() + index);
+        RebuildIndex();
+        return MakeIterator(index);
+    }
+
+    // Удаляет элемент с ключом key и возвращает число удалённых элементов
+    size_t Erase(const K& key) {
+        const size_t index = FindIndex(key);
+        if (index == items_.Size()) {
+            return 0;
+        }
+        Erase(cbegin() + index);
+        return 1;
+    }
+
+    // Удаляет все элементы, удовлетворяющие pred, за один проход
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        const size_t count = items_.EraseIf(pred);
+        if (count != 0) {
+            RebuildIndex();
+        }
+        return count;
+    }
+
+    friend bool operator==(const FlatTree& lhs, const FlatTree& rhs) {
+        return std::equal(lhs.items_.begin(), lhs.items_.end(), rhs.items_.begin(), rhs.items_.end());
+    }
+
+protected:
+    Items items_;
+    typename SearchPolicy::template Index<K> index_;
+    [[no_unique_address]] Compare comp_;
+
+    auto ValueLess() const {
+        return [this](const Value& lhs, const Value& rhs) {
+            return comp_(KeyOf{}(lhs), KeyOf{}(rhs));
+        };
+    }
+
+    iterator MakeIterator(size_t index) noexcept {
+        return iterator(items_.begin() + index);
+    }
+    const_iterator MakeIterator(size_t index) const noexcept {
+        return const_iterator(items_.cbegin() + index);
+    }
+
+    bool Equivalent(const K& lhs, const K& rhs) const {
+        return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+    }
+
+    size_t LowerBoundIndex(const K& key) const noexcept {
+        return index_.LowerBound(items_.GetAddress(), items_.Size(), KeyOf{}, key, comp_);
+    }
+
+    // Индекс элемента с ключом key или Size(), если его нет
+    size_t FindIndex(const K& key) const noexcept {
+        const size_t index = LowerBoundIndex(key);
+        if (index != items_.Size() && !comp_(key, KeyOf{}(items_[index]))) {
+            return index;
+        }
+        return items_.Size();
+    }
+
+    // Перестраивает индекс. Если на это не хватит памяти, контейнер очищается: иначе
+    // поиск шёл бы по устаревшему индексу. Индекс пустого контейнера память не выделяет
+    void RebuildIndex() {
+        try {
+            index_.Rebuild(items_.GetAddress(), items_.Size(), KeyOf{});
+        } catch (...) {
+            items_.Clear();
+            index_.Rebuild(items_.GetAddress(), 0, KeyOf{});
+            throw;
+        }
+    }
+
+    // Добавляет пакет в конец вызовом append. Прежние элементы и индекс при этом не меняются,
+    // поэтому при исключении достаточно удалить уже добавленную часть пакета
+    template <typename Append>
+    void AppendBatch(size_t old_size, Append append) {
+        try {
+            append();
+        } catch (...) {
+            items_.Erase(items_.cbegin() + old_size, items_.cend());
+            throw;
+        }
+    }
+
+    template <typename Arg>
+    std::pair<iterator, bool> EmplaceUnique(Arg&& value) {
+        const size_t index = LowerBoundIndex(KeyOf{}(value));
+        if (index != items_.Size() && !comp_(KeyOf{}(value), KeyOf{}(items_[index]))) {
+            return {MakeIterator(index), false};
+        }
+        items_.Emplace(items_.cbegin() + index, std::forward<Arg>(value));
+        RebuildIndex();
+        return {MakeIterator(index), true};
+    }
+
+    // Сливает отсортированные элементы, добавленные в конец начиная с old_size, с прежними.
+    // Если исключение бросит перемещение элемента или сравнение ключей во время слияния,
+    // порядок прежних элементов уже нарушен, и контейнер очищается
+    void MergeAppended(size_t old_size) {
+        const auto equivalent = [this](const Value& lhs, const Value& rhs) {
+            return Equivalent(KeyOf{}(lhs), KeyOf{}(rhs));
+        };
+        bool needs_merge = false;
+        AppendBatch(old_size, [&] {
+            // Повторы внутри пакета: остаётся первый из равных
+            items_.Erase(std::unique(items_.begin() + old_size, items_.end(), equivalent), items_.end());
+            // Пакет целиком правее прежних элементов (например, новые отметки времени): слияние не нужно
+            needs_merge = old_size != 0 && old_size != items_.Size()
+                && !comp_(KeyOf{}(items_[old_size - 1]), KeyOf{}(items_[old_size]));
+        });
+        if (needs_merge) {
+            try {
+                // Слияние устойчиво: из равных элементов прежний оказывается первым и остаётся
+                std::inplace_merge(items_.begin(), items_.begin() + old_size, items_.end(), ValueLess());
+                items_.Erase(std::unique(items_.begin(), items_.end(), equivalent), items_.end());
+            } catch (...) {
+                Clear();
+                throw;
+            }
+        }
+        RebuildIndex();
+    }
+};
+
+// Элементы FlatSet — сами ключи, поэтому оба итератора константные, как у std::flat_set
+struct Identity {
+    template <typename Items, bool IsConst>
+    using Iterator = typename Items::const_iterator;
+
+    template <typename T>
+    const T& operator()(const T& value) const noexcept {
+        return value;
+    }
+};
+
+struct PairKey {
+    template <typename Items, bool IsConst>
+    using Iterator = PairIterator<Items, IsConst>;
+
+    template <typename Pair>
+    const auto& operator()(const Pair& value) const noexcept {
+        return value.first;
+    }
+};
+
+}  // namespace flat_map_detail
+
+// Упорядоченное множество уникальных ключей в непрерывном отсортированном векторе
+template <typename K, typename Compare = std::less<K>, typename SearchPolicy = BranchlessSearch>
+class FlatSet : public flat_map_detail::FlatTree<K, K, flat_map_detail::Identity, Compare, SearchPolicy> {
+    using Base = flat_map_detail::FlatTree<K, K, flat_map_detail::Identity, Compare, SearchPolicy>;
+
+public:
+    using Base::Base;
+};
+
+// Упорядоченный словарь в непрерывном векторе пар ключ-значение, отсортированном по ключу
+template <typename K, typename V, typename Compare = std::less<K>, typename SearchPolicy = BranchlessSearch>
+class FlatMap
+    : public flat_map_detail::FlatTree<K, std::pair<K, V>, flat_map_detail::PairKey, Compare, SearchPolicy> {
+    using Base = flat_map_detail::FlatTree<K, std::pair<K, V>, flat_map_detail::PairKey, Compare, SearchPolicy>;
+
+public:
+    using mapped_type = V;
+    using typename Base::iterator;
+
+    using Base::Base;
+
+    // Вставляет элемент с ключом key и значением из args, если такого ключа ещё нет
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const K& key, Args&&... args) {
+        const size_t index = this->LowerBoundIndex(key);
+        if (index != this->items_.Size() && !this->comp_(key, this->items_[index].first)) {
+            return {this->MakeIterator(index), false};
+        }
+        this->items_.Emplace(this->items_.cbegin() + index, std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        this->RebuildIndex();
+        return {this->MakeIterator(index), true};
+    }
+
+    // Значение по ключу; при отсутствии ключа вставляет значение по умолчанию
+    V& operator[](const K& key) {
+        return TryEmplace(key).first->second;
+    }
+
+    const V& At(const K& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    V& At(const K& key) {
+        const size_t index = this->FindIndex(key);
+        if (index == this->items_.Size()) {
+            throw std::out_of_range("FlatMap::At: key is not found");
+        }
+        return this->items_[index].second;
+    }
+};
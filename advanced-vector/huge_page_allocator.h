@@ -0,0 +1,174 @@
+#pragma once
+#include "vector.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstdint>
+#include <limits>
+
+// Способ получения больших страниц для крупных блоков
+enum class HugePageMode {
+    // Прозрачные большие страницы: регион выравнивается по 2 МиБ и помечается MADV_HUGEPAGE
+    TRANSPARENT,
+    // Явные большие страницы hugetlbfs (MAP_HUGETLB). Если зарезервированных страниц
+    // не хватает, используются прозрачные большие страницы
+    EXPLICIT,
+};
+
+// Размещение крупных блоков по узлам NUMA
+enum class NumaPolicy {
+    // Страницы размещаются на узле потока, первым обратившегося к ним (поведение ядра по умолчанию)
+    FIRST_TOUCH,
+    // Страницы размещаются только на узле numa_node
+    BIND,
+    // Узел numa_node предпочтителен, но при нехватке памяти допускаются другие узлы
+    PREFERRED,
+};
+
+struct HugePageOptions {
+    HugePageMode mode = HugePageMode::TRANSPARENT;
+    NumaPolicy numa_policy = NumaPolicy::FIRST_TOUCH;
+    int numa_node = 0;
+};
+
+// Аллокатор, выделяющий блоки от MinHugeBytes байт из регионов, выровненных по большим
+// страницам, и при необходимости привязывающий их к узлу NUMA. Меньшие блоки выделяются
+// через operator new. Размер крупного блока округляется до целого числа больших страниц,
+// излишек отдаётся вектору как вместимость (AllocateAtLeast).
+// Привязка к узлу и madvise выполняются по возможности: если ядро их не поддерживает,
+// блок остаётся обычной памятью. Любой экземпляр может освободить память другого,
+// поэтому аллокаторы равны независимо от настроек
+template <typename T, size_t MinHugeBytes = size_t{2} << 20>
+class HugePageAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, MinHugeBytes>;
+    };
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+    HugePageAllocator() = default;
+
+    explicit HugePageAllocator(const HugePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, MinHugeBytes>& other) noexcept
+        : options_(other.GetOptions()) {
+    }
+
+    const HugePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    T* allocate(size_t n) {
+        return AllocateAtLeast(n).ptr;
+    }
+
+    AllocationResult<T> AllocateAtLeast(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (!IsHuge(bytes)) {
+            return {static_cast<T*>(::operator new(bytes, std::align_val_t{alignof(T)})), n};
+        }
+        // Размер округляется до больших страниц, а MapHugeRegion добавляет ещё одну страницу
+        // для выравнивания: обе прибавки должны помещаться в size_t
+        if (bytes > std::numeric_limits<size_t>::max() - 2 * HUGE_PAGE_SIZE) {
+            throw std::bad_array_new_length();
+        }
+        const size_t huge_bytes = RoundToHugePages(bytes);
+        void* region = MapHugeRegion(huge_bytes);
+        ApplyNumaPolicy(region, huge_bytes);
+        return {static_cast<T*>(region), huge_bytes / sizeof(T)};
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (IsHuge(bytes)) {
+            munmap(buf, RoundToHugePages(bytes));
+        } else {
+            ::operator delete(buf, std::align_val_t{alignof(T)});
+        }
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, MinHugeBytes>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U, MinHugeBytes>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static bool IsHuge(size_t bytes) noexcept {
+        return bytes >= MinHugeBytes;
+    }
+
+    static size_t RoundToHugePages(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    void* MapHugeRegion(size_t bytes) const {
+        if (options_.mode == HugePageMode::EXPLICIT) {
+            void* region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (region != MAP_FAILED) {
+                return region;
+            }
+        }
+        // Запрашиваем на одну большую страницу больше и обрезаем края, чтобы начало
+        // региона оказалось на границе 2 МиБ
+        const size_t padded_bytes = bytes + HUGE_PAGE_SIZE;
+        void* padded = mmap(nullptr, padded_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (padded == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(padded);
+        const uintptr_t aligned = (begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        if (aligned != begin) {
+            munmap(padded, aligned - begin);
+        }
+        const uintptr_t tail = aligned + bytes;
+        const uintptr_t padded_end = begin + padded_bytes;
+        if (tail != padded_end) {
+            munmap(reinterpret_cast<void*>(tail), padded_end - tail);
+        }
+        void* region = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(region, bytes, MADV_HUGEPAGE);
+#endif
+        return region;
+    }
+
+    void ApplyNumaPolicy(void* region, size_t bytes) const noexcept {
+#ifdef SYS_mbind
+        // Значения MPOL_* из <numaif.h>; системный вызов позволяет обойтись без libnuma
+        const int MPOL_PREFERRED_MODE = 1;
+        const int MPOL_BIND_MODE = 2;
+        if (options_.numa_policy == NumaPolicy::FIRST_TOUCH || options_.numa_node < 0
+            || options_.numa_node >= static_cast<int>(sizeof(unsigned long) * CHAR_BIT)) {
+            return;
+        }
+        const unsigned long node_mask = 1UL << options_.numa_node;
+        const int mode = options_.numa_policy == NumaPolicy::BIND ? MPOL_BIND_MODE : MPOL_PREFERRED_MODE;
+        syscall(SYS_mbind, region, bytes, mode, &node_mask, sizeof(node_mask) * CHAR_BIT, 0);
+#else
+        (void)region;
+        (void)bytes;
+#endif
+    }
+
+    HugePageOptions options_;
+};
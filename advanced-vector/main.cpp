@@ -1,8 +1,41 @@
+#include "concurrent_vector.h"
+#include "flat_map.h"
+#include "huge_page_allocator.h"
+#include "mmap_vector.h"
+#include "pool_allocator.h"
+#include "segmented_vector.h"
+#include "shared_vector.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
 #include "vector.h"
+#include "vector_io.h"
+#include "vector_simd.h"
+#include "vector_stats.h"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iomanip>
 #include <iostream>
+#include <latch>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <source_location>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -116,8 +149,120 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+// Ресурс памяти, подсчитывающий выделения и освобождения
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {
+    }
+
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_in_use = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        bytes_in_use += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        bytes_in_use -= bytes;
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+};
+
+// Дескриптор, который заявляет о тривиальной перемещаемости и считает перемещения
+struct Handle {
+    explicit Handle(int value)
+        : value(new int(value)) {
+    }
+    Handle(Handle&& other) noexcept
+        : value(std::exchange(other.value, nullptr)) {
+        ++num_moved;
+    }
+    Handle& operator=(Handle&& other) noexcept {
+        std::swap(value, other.value);
+        ++num_moved;
+        return *this;
+    }
+    ~Handle() {
+        delete value;
+    }
+
+    int* value = nullptr;
+
+    static inline int num_moved = 0;
+};
+
+// Тип, конструктор перемещения которого может бросить исключение, а перемещающее
+// присваивание не бросает. Помечен как переносимый с откатом
+struct RollbackObj {
+    explicit RollbackObj(int id)
+        : id(id) {
+        ++num_alive;
+    }
+    RollbackObj(const RollbackObj& other)
+        : id(other.id) {
+        ++num_copied;
+        ++num_alive;
+    }
+    RollbackObj(RollbackObj&& other) noexcept(false)
+        : id(other.id) {
+        if (other.id == throw_on_move_id) {
+            throw std::runtime_error("Oops");
+        }
+        other.id = -1;
+        ++num_moved;
+        ++num_alive;
+    }
+    RollbackObj& operator=(const RollbackObj& other) = default;
+    RollbackObj& operator=(RollbackObj&& other) noexcept {
+        id = std::exchange(other.id, -1);
+        ++num_move_assigned;
+        return *this;
+    }
+    ~RollbackObj() {
+        --num_alive;
+    }
+
+    static void ResetCounters() {
+        num_alive = 0;
+        num_copied = 0;
+        num_moved = 0;
+        num_move_assigned = 0;
+        throw_on_move_id = -1;
+    }
+
+    int id;
+
+    static inline std::atomic<int> num_alive = 0;
+    static inline std::atomic<int> num_copied = 0;
+    static inline std::atomic<int> num_moved = 0;
+    static inline std::atomic<int> num_move_assigned = 0;
+    static inline int throw_on_move_id = -1;
+};
+
+struct Pod64 {
+    int64_t values[8];
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<Handle> : std::true_type {};
+
+template <>
+struct IsRollbackRelocatable<RollbackObj> : std::true_type {};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -432,7 +577,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -447,7 +592,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -494,7 +639,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -510,7 +655,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -529,7 +674,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -545,7 +690,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -559,116 +704,2496 @@ void Test6() {
     //(void)ID;
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    const size_t SIZE = 100;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        CountingResource resource;
+        {
+            pmr::Vector<Obj> v(SIZE, &resource);
+            assert(v.GetAllocator().resource() == &resource);
+            assert(resource.allocations == 1);
+            v.PushBack(Obj{ID});
+            assert(resource.allocations == 2);
+            assert(resource.deallocations == 1);
+            assert(resource.bytes_in_use == SIZE * 2 * sizeof(Obj));
+        }
+        assert(resource.allocations == resource.deallocations);
+        assert(resource.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        // Память монотонного ресурса освобождается разом, вектор её не возвращает по одному блоку
+        std::array<std::byte, 4096> buffer;
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+            std::pmr::null_memory_resource());
+        pmr::Vector<int> v(&arena);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == 100);
+        assert(v[99] == 99);
+        assert(reinterpret_cast<std::byte*>(&v[0]) >= buffer.data());
+        assert(reinterpret_cast<std::byte*>(&v[0]) < buffer.data() + buffer.size());
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        // Копия получает аллокатор через select_on_container_copy_construction,
+        // то есть ресурс по умолчанию
+        CountingResource resource;
+        pmr::Vector<int> v(SIZE, &resource);
+        pmr::Vector<int> v_copy(v);
+        assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        pmr::Vector<int> v_copy_on_resource(v, &resource);
+        assert(v_copy_on_resource.GetAllocator().resource() == &resource);
+        assert(resource.allocations == 2);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+    {
+        // polymorphic_allocator не распространяется при присваивании:
+        // при разных ресурсах элементы перемещаются поштучно
+        Obj::ResetCounters();
+        CountingResource left_resource;
+        CountingResource right_resource;
+        {
+            pmr::Vector<Obj> left(&left_resource);
+            pmr::Vector<Obj> right(SIZE, &right_resource);
+            right[SIZE - 1].id = ID;
+            left = std::move(right);
+            assert(left.GetAllocator().resource() == &left_resource);
+            assert(left.Size() == SIZE);
+            assert(left[SIZE - 1].id == ID);
+            assert(Obj::num_moved == SIZE);
+            assert(left_resource.allocations == 1);
+            assert(right_resource.allocations == 1);
+
+            pmr::Vector<Obj> same(&left_resource);
+            same = std::move(left);
+            assert(Obj::num_moved == SIZE);
+            assert(same.Size() == SIZE);
+            assert(left_resource.allocations == 1);
         }
-        return *this;
-    }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+        assert(left_resource.bytes_in_use == 0);
+        assert(right_resource.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    ~C() {
-        ++dtor;
+    {
+#ifndef VECTOR_DEBUG_ITERATORS
+        // std::allocator не занимает места в векторе
+        static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+#endif
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+void Test8() {
+    const size_t SIZE = 100;
+    {
+        static_assert(IsTriviallyRelocatableV<int>);
+        static_assert(IsTriviallyRelocatableV<Pod64>);
+        static_assert(IsTriviallyRelocatableV<std::unique_ptr<int>>);
+        static_assert(!IsTriviallyRelocatableV<Obj>);
+    }
+    {
+        Vector<Pod64> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(Pod64{{static_cast<int64_t>(i)}});
+        }
+        v.Insert(v.cbegin() + 1, Pod64{{-1}});
+        v.Erase(v.cbegin() + 3);
+        assert(v.Size() == SIZE);
+        assert(v[0].values[0] == 0);
+        assert(v[1].values[0] == -1);
+        assert(v[2].values[0] == 1);
+        assert(v[3].values[0] == 3);
+        assert(v[SIZE - 1].values[0] == static_cast<int64_t>(SIZE - 1));
     }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin(), std::make_unique<int>(-1));
+        v.Erase(v.cbegin() + 1);
+        assert(v.Size() == SIZE);
+        assert(*v[0] == -1);
+        assert(*v[1] == 1);
+        assert(*v[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        // Переразмещение, вставка и удаление не вызывают перемещающих операций
+        Handle::num_moved = 0;
+        Vector<Handle> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(SIZE * 2);
+        v.Emplace(v.cbegin() + 1, -1);
+        v.Erase(v.cbegin());
+        assert(Handle::num_moved == 0);
+        assert(v.Size() == SIZE);
+        assert(*v[0].value == -1);
+        assert(*v[1].value == 1);
+        static_assert(noexcept(v.Erase(v.cbegin())));
+    }
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
+// Политика роста, прибавляющая фиксированное число элементов
+struct StepGrowth {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity + 10);
+    }
 };
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
+void Test9() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        std::vector<size_t> capacities;
+        for (int i = 0; i < 7; ++i) {
+            v.PushBack(i);
+            if (capacities.empty() || capacities.back() != v.Capacity()) {
+                capacities.push_back(v.Capacity());
+            }
+        }
+        assert((capacities == std::vector<size_t>{1, 2, 3, 4, 6, 9}));
+    }
+    {
+        Vector<int, std::allocator<int>, PageRoundedGrowth<>> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 4096 / sizeof(int));
+    }
+    {
+        Vector<Obj, std::allocator<Obj>, StepGrowth> v(SIZE);
+        v.EmplaceBack(1);
+        assert(v.Capacity() == SIZE + 10);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+            // Аргумент, ссылающийся на элемент, должен пережить перенос блока
+            v.PushBack(v[i / 2]);
+        }
+        assert(v.Size() == SIZE * 2);
+        assert(v.Capacity() >= v.Size());
+        assert(v[0] == 0);
+        assert(v[1] == 0);
+        assert(v[2] == 1);
+        v.Insert(v.cbegin(), -1);
+        v.Reserve(SIZE * 10);
+        assert(v.Capacity() >= SIZE * 10);
+        assert(v[0] == -1);
+        assert(v[3] == 1);
+    }
+    {
+        // Излишек блока, выделенного malloc, становится вместимостью
+        Vector<char, MallocAllocator<char>> v;
+        v.Reserve(1);
+        assert(v.Capacity() >= 1);
+        const size_t capacity = v.Capacity();
+        for (size_t i = 0; i < capacity; ++i) {
+            v.PushBack('a');
+        }
+        assert(v.Capacity() == capacity);
+    }
+    {
+        // Размер блока, не помещающийся в size_t, не усекается
+        Vector<int, MallocAllocator<int>> v;
+        try {
+            v.Reserve(std::numeric_limits<size_t>::max() / sizeof(int) + 2);
+            assert(false);
+        } catch (const std::bad_array_new_length&) {
+        }
+        assert(v.Capacity() == 0);
+        v.Resize(64);
+        assert(v.Size() == 64 && v.Capacity() >= 64);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+void Test10() {
+    const size_t INLINE = 4;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        CountingResource resource;
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            SmallVector<Obj, INLINE, std::pmr::polymorphic_allocator<Obj>> v(&resource);
+            for (size_t i = 0; i < INLINE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(v.IsInline());
+            assert(v.Capacity() == INLINE);
+            assert(resource.allocations == 0);
+            v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+            assert(!v.IsInline());
+            assert(v.Size() == INLINE + 1);
+            assert(v.Capacity() == INLINE * 2);
+            assert(resource.allocations == 1);
+            assert(v[1].id == ID);
+            assert(v[1].name == "Ivan"s);
+            assert(v[2].id == 1);
+            v.Erase(v.cbegin());
+            assert(v[0].id == ID);
+            assert(Obj::GetAliveObjectCount() == INLINE);
         }
-        Dump();
-    } catch (...) {
+        assert(resource.bytes_in_use == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
-        }
-        Dump();
-    } catch (...) {
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, INLINE> v(INLINE - 1);
+        v[0].id = ID;
+        SmallVector<Obj, INLINE> moved(std::move(v));
+        assert(moved.IsInline());
+        assert(moved.Size() == INLINE - 1);
+        assert(moved[0].id == ID);
+        assert(v.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == INLINE - 1);
+
+        SmallVector<Obj, INLINE> copy(moved);
+        assert(copy[0].id == ID);
+        copy.Resize(INLINE * 3);
+        assert(!copy.IsInline());
+        assert(copy.Size() == INLINE * 3);
+        assert(copy[0].id == ID);
+
+        // Обмен встроенного и динамического хранилищ
+        copy[INLINE * 3 - 1].id = ID + 1;
+        moved.Swap(copy);
+        assert(moved.Size() == INLINE * 3);
+        assert(!moved.IsInline());
+        assert(moved[INLINE * 3 - 1].id == ID + 1);
+        assert(copy.Size() == INLINE - 1);
+        assert(copy[0].id == ID);
+        assert(Obj::GetAliveObjectCount() == INLINE * 4 - 1);
+
+        SmallVector<Obj, INLINE> heap_moved(std::move(moved));
+        assert(heap_moved.Size() == INLINE * 3);
+        assert(moved.Size() == 0);
+        copy = heap_moved;
+        assert(copy.Size() == INLINE * 3);
+        heap_moved = std::move(v);
+        assert(heap_moved.Size() == 0);
+        copy.Resize(1);
+        copy.PopBack();
+        assert(copy.Size() == 0);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            v.reserve(NUM * 2);
-            Dump();
-            v.push_back(c);
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SmallVector<TestObj, 1> v(1);
+        // Вставка ссылки на собственный элемент при переходе во внешнюю память
+        v.PushBack(v[0]);
+        v.Insert(v.cbegin(), v[1]);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+    {
+        SmallVector<int, 2, MallocAllocator<int>> v;
+        v.Reserve(3);
+        v.Reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
         }
-        Dump();
-    } catch (...) {
+        assert(v[99] == 99);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            v.Reserve(NUM * 2);
-            Dump();
-            v.PushBack(c);
+}
+
+void Test11() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(FOR_OVERWRITE, SIZE);
+        assert(v.Size() == SIZE);
+        assert(Obj::num_default_constructed == SIZE);
+        v.ResizeForOverwrite(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(Obj::num_default_constructed == SIZE * 2);
+        v.ResizeForOverwrite(SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<char> buffer;
+        size_t received = 0;
+        for (size_t chunk = 0; chunk < 10; ++chunk) {
+            std::span<char> tail = buffer.AppendUninitialized(SIZE);
+            assert(tail.size() == SIZE);
+            assert(tail.data() == &buffer[chunk * SIZE / 2]);
+            // Имитируем неполное чтение: заполнена лишь половина
+            std::fill_n(tail.data(), SIZE / 2, static_cast<char>('a' + chunk));
+            received += SIZE / 2;
+            buffer.ResizeForOverwrite(received);
         }
-        Dump();
-    } catch (...) {
+        assert(buffer.Size() == SIZE * 5);
+        assert(buffer.Capacity() < SIZE * 10);
+        assert(buffer[0] == 'a');
+        assert(buffer[SIZE * 5 - 1] == 'j');
+    }
+    {
+        Vector<float> v(FOR_OVERWRITE, SIZE);
+        std::fill(v.begin(), v.end(), 1.5f);
+        std::span<float> tail = v.AppendUninitialized(1);
+        tail[0] = 2.5f;
+        assert(v.Size() == SIZE + 1);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[SIZE - 1] == 1.5f);
+        assert(v[SIZE] == 2.5f);
     }
 }
 
-int main() {
+void Test12() {
+    const size_t SIZE = 10;
+    {
+        Vector<int> v{1, 2, 3};
+        assert(v.Size() == 3);
+        assert(v.Capacity() == 3);
+        assert(v[0] == 1);
+        assert(v[2] == 3);
+        const std::vector<int> items{10, 20, 30, 40};
+        auto pos = v.Insert(v.cbegin() + 1, items.begin(), items.end());
+        assert(pos == v.begin() + 1);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 10, 20, 30, 40, 2, 3}));
+        v.Insert(v.cbegin(), 2, v[6]);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{3, 3, 1, 10, 20, 30, 40, 2, 3}));
+        v.AppendRange(std::views::iota(100, 103));
+        assert(v.Size() == 12);
+        assert(v[11] == 102);
+    }
+    {
+        // Вставка в пределах вместимости: один сдвиг хвоста без выделения памяти
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const std::vector<Obj> items{Obj{1}, Obj{2}, Obj{3}};
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 2, items.begin(), items.end());
+        assert(v.Size() == SIZE + 3);
+        assert(v.Capacity() == SIZE * 2);
+        assert(v[2].id == 1);
+        assert(v[4].id == 3);
+        assert(Obj::num_moved == 3);
+        assert(Obj::num_move_assigned == SIZE - 2 - 3);
+        assert(Obj::num_assigned == 3);
+        assert(Obj::num_copied == 0);
+
+        // Хвост короче вставляемого диапазона
+        Obj::ResetCounters();
+        v.Insert(v.cend() - 1, 5, Obj{7});
+        assert(v.Size() == SIZE + 8);
+        assert(v[SIZE + 2].id == 7);
+        assert(v[SIZE + 6].id == 7);
+        assert(v[SIZE + 7].id == 0);
+        assert(Obj::num_copied == 5);
+        assert(Obj::num_assigned == 1);
+        assert(Obj::num_moved == 1);
+    }
+    {
+        // При реаллокации память выделяется один раз под весь диапазон
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        const std::vector<Obj> items(SIZE * 3);
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 1, items.begin(), items.end());
+        assert(v.Size() == SIZE * 4);
+        assert(v.Capacity() == SIZE * 4);
+        assert(Obj::num_copied == SIZE * 3);
+        assert(Obj::num_moved == SIZE);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Vector<Obj> items(3);
+        items[1].throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, items.begin(), items.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(Obj::GetAliveObjectCount() == SIZE + 3);
+    }
+    {
+        std::istringstream input("4 5 6");
+        Vector<int> v{1, 2, 3};
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 4, 5, 6, 2, 3}));
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 1000;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v[SIZE / 2 - 1].id = 42;
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE / 2);
+        assert(v.Capacity() == SIZE / 2);
+        assert(v[SIZE / 2 - 1].id == 42);
+        assert(Obj::num_moved == SIZE / 2);
+        assert(Obj::num_copied == 0);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+        v.ShrinkToFit();
+        assert(Obj::num_moved == SIZE / 2);
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        CountingResource resource;
+        pmr::Vector<int> v(SIZE, &resource);
+        v.Resize(1);
+        v.ShrinkToFit();
+        assert(resource.bytes_in_use == sizeof(int));
+    }
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() >= 10);
+        assert(v.Capacity() < SIZE);
+        assert(v[9] == 9);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> small(SIZE / 10);
+        Vector<int> large(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            large[i] = static_cast<int>(i);
+        }
+        small = large;
+        assert(small.Size() == SIZE);
+        assert(small.Capacity() == SIZE);
+        assert(small[SIZE - 1] == static_cast<int>(SIZE - 1));
+
+        Vector<int> tiny{7, 8};
+        small = tiny;
+        assert(small.Size() == 2);
+        assert(small.Capacity() == SIZE);
+        assert(small[1] == 8);
+    }
+    {
+        // Старый буфер возвращается сразу после выделения нового
+        CountingResource resource;
+        pmr::Vector<int> target(SIZE, &resource);
+        pmr::Vector<int> source(&resource);
+        source.Resize(SIZE * 2);
+        source[SIZE] = 42;
+        const size_t before = resource.allocations;
+        target = source;
+        assert(resource.allocations == before + 1);
+        assert(resource.bytes_in_use == SIZE * 4 * sizeof(int));
+        assert(target[SIZE] == 42);
+
+        // Перемещение между разными ресурсами для тривиальных типов — то же копирование
+        CountingResource other;
+        pmr::Vector<int> moved(&other);
+        moved = std::move(source);
+        assert(moved.Size() == SIZE * 2);
+        assert(moved[SIZE] == 42);
+        assert(other.allocations == 1);
+    }
+    {
+        // Строгая гарантия: при исключении копирования вектор не меняется
+        Obj::ResetCounters();
+        Vector<Obj> target(SIZE / 10);
+        target[0].id = 42;
+        Vector<Obj> source(SIZE);
+        source[SIZE / 2].throw_on_copy = true;
+        try {
+            target = source;
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(target.Size() == SIZE / 10);
+        assert(target[0].id == 42);
+        assert(Obj::GetAliveObjectCount() == SIZE + SIZE / 10);
+    }
+}
+
+struct StatsTestTag {
+    static constexpr std::string_view NAME = "test";
+};
+
+// Тип, перемещение которого может бросить исключение, поэтому при реаллокации он копируется
+struct MayThrowOnMove {
+    MayThrowOnMove() = default;
+    MayThrowOnMove(const MayThrowOnMove&) = default;
+    MayThrowOnMove(MayThrowOnMove&& /*other*/) noexcept(false) {
+    }
+    MayThrowOnMove& operator=(const MayThrowOnMove&) = default;
+};
+
+struct CopyStatsTestTag {
+    static constexpr std::string_view NAME = "test-copies";
+};
+
+void Test15() {
+    using Stats = CountingStats<StatsTestTag>;
+    {
+        Vector<Obj, std::allocator<Obj>, DoublingGrowth, Stats> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(100);
+        v.ShrinkToFit();
+    }
+    const VectorStats& stats = Stats::Get();
+    // Вместимость: 1, 2, 4, 8, 100 и 5 после ShrinkToFit
+    assert(stats.allocations == 6);
+    assert(stats.deallocations == 6);
+    assert(stats.bytes_allocated == (1 + 2 + 4 + 8 + 100 + 5) * sizeof(Obj));
+    assert(stats.bytes_allocated == stats.bytes_deallocated);
+    assert(stats.reallocations == 6);
+    assert(stats.elements_moved == 1 + 2 + 4 + 5 + 5);
+    assert(stats.elements_copied == 0);
+    assert(stats.peak_capacity == 100);
+
+    using CopyStats = CountingStats<CopyStatsTestTag>;
+    {
+        Vector<MayThrowOnMove, std::allocator<MayThrowOnMove>, DoublingGrowth, CopyStats> v(4);
+        v.Reserve(8);
+    }
+    assert(CopyStats::Get().elements_copied == 4);
+    assert(CopyStats::Get().elements_moved == 0);
+
+    const auto samples = VectorStatsRegistry::Instance().Sample();
+    const auto sample = std::find_if(samples.begin(), samples.end(), [](const VectorStatsSample& item) {
+        return item.name == "test";
+    });
+    assert(sample != samples.end());
+    assert(sample->allocations == 6);
+    assert(sample->peak_capacity == 100);
+}
+
+void Test16() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto pos = v.EraseUnordered(v.cbegin() + 2);
+        assert(pos == v.begin() + 2);
+        assert(v.Size() == SIZE - 1);
+        assert(v[2].id == static_cast<int>(SIZE - 1));
+        assert(Obj::num_move_assigned == 1);
+        v.EraseUnordered(v.cend() - 1);
+        assert(v.Size() == SIZE - 2);
+        assert(v[SIZE - 3].id == static_cast<int>(SIZE - 3));
+
+        // 0 1 9 3 4 5 6 7 -> 0 5 6 7
+        const int old_move_assigned = Obj::num_move_assigned;
+        pos = v.Erase(v.cbegin() + 1, v.cbegin() + 5);
+        assert(pos == v.begin() + 1);
+        assert(v.Size() == 4);
+        assert(v[1].id == 5);
+        assert(v[3].id == 7);
+        assert(Obj::num_move_assigned == old_move_assigned + 3);
+        assert(Obj::GetAliveObjectCount() == 4);
+        v.Erase(v.cbegin(), v.cbegin());
+        assert(v.Size() == 4);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE * 10);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        const size_t removed = v.EraseIf([](const Obj& obj) {
+            return obj.id % 3 != 0;
+        });
+        assert(removed == 66);
+        assert(v.Size() == 34);
+        assert(v[1].id == 3);
+        assert(v[33].id == 99);
+        assert(Obj::GetAliveObjectCount() == 34);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.EraseUnordered(v.cbegin());
+        assert(*v[0] == static_cast<int>(SIZE - 1));
+        v.Erase(v.cbegin() + 1, v.cbegin() + 3);
+        assert(*v[1] == 3);
+        v.EraseIf([](const std::unique_ptr<int>& p) {
+            return *p % 2 == 0;
+        });
+        assert(v.Size() == 4);
+        assert(*v[0] == 9);
+        assert(*v[3] == 7);
+    }
+}
+
+void Test17() {
+    const size_t HUGE_PAGE = size_t{2} << 20;
+    {
+        // Мелкие блоки выделяются как обычно
+        Vector<int, HugePageAllocator<int>> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 1);
+    }
+    {
+        Vector<int, HugePageAllocator<int>> v;
+        const int count = static_cast<int>(HUGE_PAGE / sizeof(int) * 2);
+        for (int i = 0; i < count; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == static_cast<size_t>(count));
+        assert(v[count - 1] == count - 1);
+        assert(reinterpret_cast<uintptr_t>(&v[0]) % HUGE_PAGE == 0);
+        // Блок округлён до целого числа больших страниц, излишек стал вместимостью
+        assert(v.Capacity() * sizeof(int) % HUGE_PAGE == 0);
+    }
+    {
+        HugePageOptions options;
+        options.mode = HugePageMode::EXPLICIT;
+        options.numa_policy = NumaPolicy::PREFERRED;
+        options.numa_node = 0;
+        Vector<Pod64, HugePageAllocator<Pod64>> v(HUGE_PAGE / sizeof(Pod64) + 1,
+            HugePageAllocator<Pod64>(options));
+        assert(v.GetAllocator().GetOptions().numa_policy == NumaPolicy::PREFERRED);
+        assert(v.Capacity() == HUGE_PAGE * 2 / sizeof(Pod64));
+        v[v.Size() - 1].values[0] = 42;
+        Vector<Pod64, HugePageAllocator<Pod64>> copy(v);
+        assert(copy[copy.Size() - 1].values[0] == 42);
+        v.ShrinkToFit();
+    }
+    {
+        // Размер, переполняющийся при умножении или округлении до больших страниц, отвергается
+        const size_t max_count = std::numeric_limits<size_t>::max() / sizeof(int);
+        for (size_t n : {max_count + 1, max_count}) {
+            try {
+                HugePageAllocator<int>().allocate(n);
+                assert(false);
+            } catch (const std::bad_array_new_length&) {
+            }
+        }
+    }
+}
+
+void Test18() {
+    const std::string path = "/tmp/advanced_vector_test18_" + std::to_string(getpid()) + ".bin";
+    unlink(path.c_str());
+    const int count = 10000;
+    {
+        auto v = MmapVector<Pod64>::Open(path);
+        assert(v.IsOpen() && v.Size() == 0 && v.Capacity() == 0);
+        for (int i = 0; i < count; ++i) {
+            v.PushBack(Pod64{{i}});
+        }
+        // Аргумент ссылается на элемент, а расширение перемещает отображение
+        v.Resize(v.Capacity());
+        v.PushBack(v[0]);
+        assert(v[v.Size() - 1].values[0] == 0);
+        assert(v[count].values[0] == 0 && v[count].values[7] == 0);
+        v.Resize(count);
+        v.Sync();
+    }
+    {
+        // Повторное открытие видит данные без копирования
+        auto v = MmapVector<Pod64>::Open(path);
+        assert(v.Size() == static_cast<size_t>(count));
+        assert(v.Capacity() >= v.Size());
+        for (int i = 0; i < count; ++i) {
+            assert(v[i].values[0] == i);
+        }
+        v.PopBack();
+        v.Reserve(count * 4);
+        assert(v.Capacity() == static_cast<size_t>(count * 4));
+        int64_t sum = 0;
+        for (const Pod64& item : v) {
+            sum += item.values[0];
+        }
+        assert(sum == int64_t{count - 1} * (count - 2) / 2);
+        MmapVector<Pod64> moved(std::move(v));
+        assert(!v.IsOpen() && moved.Size() == static_cast<size_t>(count - 1));
+
+        // Вектор без файла пуст: уменьшать его можно, а расширять нельзя
+        v.Resize(0);
+        v.Reserve(0);
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        for (size_t attempt = 0; attempt < 3; ++attempt) {
+            try {
+                if (attempt == 0) {
+                    v.Resize(1);
+                } else if (attempt == 1) {
+                    v.EmplaceBack();
+                } else {
+                    v.Reserve(1);
+                }
+                assert(false);
+            } catch (const std::logic_error&) {
+            }
+        }
+        assert(!v.IsOpen());
+    }
+    {
+        // Файл другого типа элементов не открывается
+        bool thrown = false;
+        try {
+            auto v = MmapVector<int>::Open(path);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    unlink(path.c_str());
+}
+
+void Test19() {
+    {
+        Vector<float, AlignedAllocator<float, 64>> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(reinterpret_cast<uintptr_t>(v.GetAddress()) % 64 == 0);
+            // Вместимость дополнена до целого числа 64-байтных отрезков
+            assert(v.Capacity() * sizeof(float) % 64 == 0);
+        }
+        v.Reserve(17);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 112 && v[99] == 99.0f);
+    }
+    {
+        // По умолчанию выравнивание равно alignof(T), в том числе для сверхвыровненных типов
+        struct alignas(32) Lane {
+            float values[8];
+        };
+        Vector<Lane, AlignedAllocator<Lane>> v(3);
+        assert(reinterpret_cast<uintptr_t>(v.GetAddress()) % 32 == 0);
+        assert(v.Capacity() == 3);
+        Vector<Lane, AlignedAllocator<Lane>> copy(v);
+        copy = v;
+        assert(copy.Size() == 3);
+    }
+    {
+        // Аллокатор переносится на другие типы с сохранением выравнивания
+        using Rebound = std::allocator_traits<AlignedAllocator<float, 32>>::rebind_alloc<double>;
+        static_assert(Rebound::ALIGNMENT == 32);
+        Rebound alloc;
+        double* buf = alloc.allocate(1);
+        assert(reinterpret_cast<uintptr_t>(buf) % 32 == 0);
+        alloc.deallocate(buf, 1);
+    }
+    {
+        // Размер, переполняющийся при умножении или при округлении, отвергается
+        AlignedAllocator<char, 64> alloc;
+        for (size_t n : {std::numeric_limits<size_t>::max(), std::numeric_limits<size_t>::max() - 10}) {
+            try {
+                alloc.allocate(n);
+                assert(false);
+            } catch (const std::bad_array_new_length&) {
+            }
+        }
+        try {
+            AlignedAllocator<float, 64>().allocate(std::numeric_limits<size_t>::max() / 2);
+            assert(false);
+        } catch (const std::bad_array_new_length&) {
+        }
+    }
+}
+
+void Test20() {
+    Obj::ResetCounters();
+    {
+        SoaVector<int, Obj, double> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i, i, i * 0.5);
+        }
+        assert(v.Size() == 10 && v.Capacity() == 16);
+        // Строка добавляется из полей самого вектора, в том числе при реаллокации
+        v.Reserve(v.Size());
+        v.EmplaceBack(v.Get<0>(9), v.Get<1>(0), v.Get<2>(9));
+        assert(v.Get<0>(10) == 9 && v.Get<1>(10).id == 0 && v.Get<2>(10) == 4.5);
+
+        const std::span<double> masses = v.Column<2>();
+        assert(masses.size() == 11);
+        double sum = 0;
+        for (double mass : masses) {
+            sum += mass;
+        }
+        assert(sum == 27.0);
+
+        v.Erase(0);
+        v.Erase(v.begin() + 1);
+        auto [first, obj, mass] = v[0];
+        assert(first == 1 && obj.id == 1 && mass == 0.5);
+        first = 100;
+        assert(v.Get<0>(0) == 100);
+        int id_sum = 0;
+        for (auto [index, item, weight] : v) {
+            id_sum += item.id;
+            weight = 0;
+        }
+        assert(id_sum == 1 + 3 + 4 + 5 + 6 + 7 + 8 + 9 + 0 && v.Get<2>(8) == 0);
+        assert(std::find_if(v.begin(), v.end(), [](const auto& row) {
+            return std::get<0>(row) == 9;
+        }) == v.end() - 2);
+
+        // Исключение при конструировании поля не меняет вектор. Первое поле новой
+        // строки, успевшее сконструироваться, разрушается
+        const int alive = Obj::GetAliveObjectCount();
+        Obj throwing(-1);
+        throwing.throw_on_copy = true;
+        try {
+            v.EmplaceBack(-1, throwing, -1.0);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 9 && Obj::GetAliveObjectCount() == alive + 1);
+
+        SoaVector<int, Obj, double> copy(v);
+        assert(copy.Size() == 9 && copy.Get<1>(7).id == 9);
+        SoaVector<int, Obj, double> other;
+        other.EmplaceBack(0, 0, 0.0);
+        other = copy;
+        other.Swap(v);
+        assert(v.Size() == 9 && other.Get<0>(0) == 100);
+        v.PopBack();
+        v.Clear();
+        assert(v.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Столбец, перемещение которого может бросить исключение, копируется при реаллокации
+        SoaVector<MayThrowOnMove, std::string> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(MayThrowOnMove{}, std::string(20, static_cast<char>('a' + i)));
+        }
+        const SoaVector<MayThrowOnMove, std::string>& const_v = v;
+        assert(const_v.Column<1>()[4] == std::string(20, 'e'));
+        assert(std::get<1>(*const_v.begin()) == std::string(20, 'a'));
+    }
+}
+
+// Тип для проверки параллельных операций: счётчики атомарны, конструктор по умолчанию
+// бросает исключение на заданном по счёту вызове, копирование — для элемента с id == throw_on_copy_id
+struct ParallelObj {
+    ParallelObj() {
+        if (++num_default_constructed == throw_on_default_construction) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    explicit ParallelObj(int id)
+        : id(id) {
+        ++num_alive;
+    }
+
+    ParallelObj(const ParallelObj& other)
+        : id(other.id) {
+        if (other.id == throw_on_copy_id) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    ParallelObj& operator=(const ParallelObj&) = default;
+
+    ~ParallelObj() {
+        --num_alive;
+    }
+
+    int id = 0;
+
+    static inline std::atomic<int> num_alive{0};
+    static inline std::atomic<int> num_default_constructed{0};
+    static inline int throw_on_default_construction = 0;
+    static inline int throw_on_copy_id = -1;
+};
+
+void Test21() {
+    const size_t SIZE = 10000;
+    const ParallelTag FOUR_THREADS{4};
+    {
+        Vector<ParallelObj> v(FOUR_THREADS, SIZE);
+        assert(v.Size() == SIZE && ParallelObj::num_alive == static_cast<int>(SIZE));
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        Vector<ParallelObj> copy(FOUR_THREADS, v);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+
+        // Копирование элемента бросает исключение: копии из других потоков разрушаются,
+        // исходный вектор не меняется
+        ParallelObj::throw_on_copy_id = static_cast<int>(SIZE / 2);
+        try {
+            v.Reserve(FOUR_THREADS, SIZE * 2);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == SIZE && ParallelObj::num_alive == static_cast<int>(SIZE * 2));
+        try {
+            Vector<ParallelObj> failed_copy(FOUR_THREADS, v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE * 2));
+        ParallelObj::throw_on_copy_id = -1;
+
+        v.Resize(FOUR_THREADS, SIZE * 3);
+        assert(v.Capacity() == SIZE * 3 && v[SIZE - 1].id == static_cast<int>(SIZE - 1) && v[SIZE].id == 0);
+        v.Resize(PARALLEL, SIZE / 2);
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE + SIZE / 2));
+        copy.Clear(FOUR_THREADS);
+        assert(copy.Size() == 0 && ParallelObj::num_alive == static_cast<int>(SIZE / 2));
+
+        ParallelObj::num_default_constructed = 0;
+        ParallelObj::throw_on_default_construction = static_cast<int>(SIZE / 3);
+        try {
+            Vector<ParallelObj> failed(FOUR_THREADS, SIZE);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ParallelObj::throw_on_default_construction = 0;
+        assert(ParallelObj::num_alive == static_cast<int>(SIZE / 2));
+    }
+    assert(ParallelObj::num_alive == 0);
+    {
+        // Тривиально перемещаемые элементы переносятся частями через memcpy
+        Vector<int> v(PARALLEL, SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        v.Reserve(FOUR_THREADS, SIZE * 2);
+        assert(v.Size() == SIZE && v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        Vector<std::string> strings(FOUR_THREADS, 100);
+        strings[99] = "long enough to be allocated on the heap";
+        strings.Reserve(FOUR_THREADS, 1000);
+        assert(strings[99] == "long enough to be allocated on the heap");
+    }
+}
+
+void Test22() {
+    {
+        const int THREADS = 4;
+        const int PER_THREAD = 20000;
+        ConcurrentVector<int> v;
+        const int& first = v.EmplaceBack(-1);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < THREADS; ++t) {
+            workers.emplace_back([&v, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    int& item = v.EmplaceBack(t * PER_THREAD + i);
+                    assert(item == t * PER_THREAD + i);
+                }
+            });
+        }
+        // Копия, снятая во время добавления, содержит только готовые элементы
+        const Vector<int> partial = v.Snapshot();
+        assert(partial.Size() <= v.Size());
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        // Элементы не перемещаются
+        assert(&first == &v[0] && first == -1);
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+
+        Vector<int> snapshot = v.Snapshot();
+        assert(snapshot.Size() == v.Size());
+        std::sort(snapshot.begin(), snapshot.end());
+        for (size_t i = 0; i < snapshot.Size(); ++i) {
+            assert(snapshot[i] == static_cast<int>(i) - 1);
+        }
+    }
+    {
+        ConcurrentVector<std::string> v;
+        v.Reserve(1000);
+        v.PushBack(std::string(40, 'a'));
+        const std::string& item = v[0];
+        for (int i = 0; i < 1000; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        assert(&item == &v[0] && v[1000] == "999");
+    }
+    {
+        // Ячейка элемента, конструктор которого бросил исключение, остаётся пустой
+        ConcurrentVector<ParallelObj> v;
+        v.EmplaceBack(1);
+        ParallelObj::num_default_constructed = 0;
+        ParallelObj::throw_on_default_construction = 1;
+        try {
+            v.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ParallelObj::throw_on_default_construction = 0;
+        v.EmplaceBack(3);
+        const Vector<ParallelObj> snapshot = v.Snapshot();
+        assert(v.Size() == 3 && snapshot.Size() == 2 && snapshot[1].id == 3);
+    }
+    assert(ParallelObj::num_alive == 0);
+}
+
+void Test23() {
+    static_assert(std::random_access_iterator<SegmentedVector<int>::iterator>);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::const_iterator>);
+    static_assert(SegmentedVector<int>::BLOCK_SIZE == 16384);
+    Obj::ResetCounters();
+    {
+        SegmentedVector<Obj, 4> v;
+        v.EmplaceBack(0);
+        const Obj& first = v[0];
+        for (int i = 1; i < 10; ++i) {
+            // Аргумент ссылается на элемент вектора, в том числе при добавлении блока
+            v.EmplaceBack(v[i - 1].id + 1);
+        }
+        // Рост не перемещает элементы
+        assert(&first == &v[0] && Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v.Size() == 10 && v.Capacity() == 12 && v[9].id == 9);
+
+        v.PopBack();
+        v.PopBack();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 8 && Obj::GetAliveObjectCount() == 8);
+
+        SegmentedVector<Obj, 4> copy(v);
+        assert(copy.Size() == 8 && copy[7].id == 7);
+        assert(std::accumulate(copy.cbegin(), copy.cend(), 0, [](int sum, const Obj& item) {
+            return sum + item.id;
+        }) == 28);
+        assert(std::find_if(v.begin(), v.end(), [](const Obj& item) {
+            return item.id == 5;
+        }) - v.begin() == 5);
+
+        const Vector<Obj> flat = v.Flatten();
+        assert(flat.Size() == 8 && flat[4].id == 4 && v.Size() == 8);
+        const int moved = Obj::num_moved;
+        const Vector<Obj> moved_flat = std::move(copy).Flatten();
+        assert(moved_flat.Size() == 8 && copy.Size() == 0 && Obj::num_moved == moved + 8);
+
+        // Исключение при конструировании элемента не меняет вектор
+        Obj throwing(-1);
+        throwing.throw_on_copy = true;
+        try {
+            v.PushBack(throwing);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 8);
+        // Исключение при копировании вектора разрушает уже скопированные элементы
+        v[5].throw_on_copy = true;
+        const int alive = Obj::GetAliveObjectCount();
+        try {
+            SegmentedVector<Obj, 4> failed_copy(v);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == alive);
+        v[5].throw_on_copy = false;
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 12);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        SegmentedVector<std::string> log;
+        log.Reserve(100000);
+        assert(log.Capacity() == 100000 / 2048 * 2048 + 2048);
+        for (int i = 0; i < 100000; ++i) {
+            log.PushBack(std::to_string(i));
+        }
+        SegmentedVector<std::string> other;
+        other = log;
+        other.Swap(log);
+        assert(log[99999] == "99999" && other[12345] == "12345");
+    }
+}
+
+// Тип без операций присваивания: ссылочное поле запрещает их
+struct NoAssign {
+    NoAssign(int* counter, int id)
+        : counter(*counter)
+        , id(id) {
+    }
+
+    int& counter;
+    int id;
+    std::string name = "not trivially copyable";
+};
+
+void Test24() {
+    const size_t SIZE = 10;
+    {
+        // Элемент конструируется прямо в ячейке, освобождённой сдвигом хвоста
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        const int old_num_moved = Obj::num_moved;
+        auto pos = v.Emplace(v.cbegin() + 3, Obj(42));
+        assert(&*pos == &v[3] && v[3].id == 42 && v.Size() == SIZE + 1);
+        assert(Obj::num_constructed_with_id == 1);
+        assert(Obj::num_moved == old_num_moved + static_cast<int>(SIZE - 3) + 1);
+        assert(Obj::num_move_assigned == 0 && Obj::num_assigned == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 1));
+    }
+    {
+        // Аргумент — элемент сдвигаемого хвоста: его адрес пересчитывается
+        Vector<Obj> v;
+        v.Reserve(SIZE * 2);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Insert(v.cbegin() + 2, v[5]);
+        assert(v[2].id == 5 && v[6].id == 5 && v[5].id == 4);
+        v.Insert(v.cbegin() + 1, v[0]);
+        assert(v[0].id == 0 && v[1].id == 0);
+        const int old_num_copied = Obj::num_copied;
+        v.Emplace(v.cbegin(), std::move(v[v.Size() - 1]));
+        assert(v[0].id == 9 && Obj::num_copied == old_num_copied);
+    }
+    {
+        // Исключение при конструировании возвращает хвост на место
+        Vector<Obj> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        Obj throwing(-1);
+        throwing.throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, throwing);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 5);
+        for (int i = 0; i < 5; ++i) {
+            assert(v[i].id == i);
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Вставка в середину не требует присваивания, если элемент конструируется в ячейке
+        int counter = 0;
+        Vector<NoAssign> v;
+        v.Reserve(SIZE);
+        v.EmplaceBack(&counter, 1);
+        v.EmplaceBack(&counter, 3);
+        v.Emplace(v.cbegin() + 1, &counter, 2);
+        v.Insert(v.cbegin(), v[2]);
+        assert(v.Size() == 4 && v[0].id == 3 && v[1].id == 1 && v[2].id == 2 && v[3].id == 3);
+        assert(&v[2].counter == &counter);
+    }
+}
+
+void Test25() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        v.Reserve(3);
+        for (int i = 0; i < 3; ++i) {
+            v.EmplaceBack(i);
+        }
+        const Obj* buffer = &v[0];
+        SharedVector<Obj> shared = std::move(v).Freeze();
+        assert(v.Size() == 0 && shared.Size() == 3 && shared.GetAddress() == buffer);
+
+        // Копии разделяют буфер, элементы не копируются
+        SharedVector<Obj> reader = shared;
+        assert(reader.GetAddress() == buffer && shared.UseCount() == 2);
+        assert(Obj::num_copied == 0 && Obj::num_moved == 0);
+
+        // Изменение разделённого буфера копирует элементы
+        shared.Mutate().EmplaceBack(3);
+        assert(Obj::num_copied == 3 && shared.Size() == 4 && reader.Size() == 3);
+        assert(reader.GetAddress() == buffer && shared.GetAddress() != buffer);
+        assert(reader.UseCount() == 1 && shared.UseCount() == 1);
+        // Единственная копия изменяется на месте
+        shared.Mutate()[0].id = 10;
+        assert(Obj::num_copied == 3 && shared[0].id == 10 && reader[0].id == 0);
+
+        int sum = 0;
+        for (const Obj& item : reader) {
+            sum += item.id;
+        }
+        assert(sum == 3);
+
+        Vector<Obj> thawed = std::move(reader).Thaw();
+        assert(thawed.GetAddress() == buffer && reader.Size() == 0 && Obj::num_copied == 3);
+
+        SharedVector<Obj> empty;
+        assert(empty.Size() == 0 && empty.begin() == empty.end());
+        empty.Mutate().EmplaceBack(1);
+        assert(empty.Size() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Читатели получают текущую версию, писатель публикует новые атомарной заменой
+        AtomicSharedVector<SharedVector<int>> table(Vector<int>{1, 2, 3}.Freeze());
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 2; ++i) {
+            readers.emplace_back([&table, &stop] {
+                while (!stop.load()) {
+                    const SharedVector<int> snapshot = table.Load();
+                    // Каждая версия — арифметическая прогрессия с шагом 1
+                    for (size_t j = 1; j < snapshot.Size(); ++j) {
+                        assert(snapshot[j] == snapshot[j - 1] + 1);
+                    }
+                }
+            });
+        }
+        for (int version = 0; version < 100; ++version) {
+            Vector<int> next(100);
+            std::iota(next.begin(), next.end(), version);
+            table.Store(std::move(next).Freeze());
+        }
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        const SharedVector<int> old = table.Exchange(SharedVector<int>());
+        assert(old.Size() == 100 && old[0] == 99 && table.Load().Size() == 0);
+    }
+}
+
+struct IoStatsTestTag {
+    static constexpr std::string_view NAME = "test-io";
+};
+
+void Test26() {
+    const std::string path = "/tmp/advanced_vector_test26_" + std::to_string(getpid()) + ".bin";
+    Vector<int> numbers(100000);
+    std::iota(numbers.begin(), numbers.end(), 0);
+    Vector<std::string> words{"alpha", "", std::string(100, 'x')};
+    for (int i = 0; i < 100000; ++i) {
+        words.PushBack(std::to_string(i));
+    }
+    {
+        // Несколько векторов подряд в одном файле: чтение не забирает данные следующего
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        WriteTo(numbers, fd);
+        WriteTo(words, fd);
+        WriteTo(Vector<Pod64>(), fd);
+        lseek(fd, 0, SEEK_SET);
+
+        using CountingVector = Vector<std::string, std::allocator<std::string>, DoublingGrowth,
+            CountingStats<IoStatsTestTag>>;
+        Vector<int> read_numbers{1, 2, 3};
+        CountingVector read_words;
+        Vector<Pod64> read_pods(3);
+        ReadFrom(read_numbers, fd);
+        ReadFrom(read_words, fd);
+        ReadFrom(read_pods, fd);
+        close(fd);
+        assert(read_numbers.Size() == numbers.Size() && std::equal(numbers.begin(), numbers.end(), read_numbers.begin()));
+        assert(read_words.Size() == words.Size() && std::equal(words.begin(), words.end(), read_words.begin()));
+        assert(read_pods.Size() == 0);
+        // Вместимость резервируется один раз по заголовку
+        assert(CountingStats<IoStatsTestTag>::Get().reallocations == 1);
+    }
+    {
+        std::stringstream stream;
+        WriteTo(words, stream);
+        WriteTo(numbers, stream);
+        VectorChunkReader<std::string> word_reader(stream);
+        Vector<std::string> chunk;
+        size_t total = 0;
+        while (const size_t count = word_reader.ReadChunk(chunk, 4096)) {
+            assert(chunk.Size() == count && chunk[0] == words[total]);
+            total += count;
+        }
+        assert(total == words.Size() && word_reader.Remaining() == 0);
+
+        VectorChunkReader<int> number_reader(stream);
+        Vector<int> numbers_chunk;
+        assert(number_reader.ReadChunk(numbers_chunk, 10) == 10 && numbers_chunk[9] == 9);
+        assert(number_reader.Remaining() == numbers.Size() - 10);
+    }
+    {
+        // Обрезанные данные и несовпадение типа элементов
+        std::stringstream whole;
+        WriteTo(numbers, whole);
+        std::stringstream truncated(whole.str().substr(0, 1000));
+        Vector<int> target{1};
+        bool thrown = false;
+        try {
+            ReadFrom(target, truncated);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && target.Size() == 0);
+
+        thrown = false;
+        try {
+            Vector<double> doubles;
+            ReadFrom(doubles, whole);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    unlink(path.c_str());
+}
+
+// Сравнивает SIMD-алгоритмы с алгоритмами стандартной библиотеки на векторах разной длины
+template <typename VectorType>
+void CheckSimdAlgorithms() {
+    using T = typename VectorType::value_type;
+    for (size_t size = 0; size <= 300; size += (size < 70 ? 1 : 23)) {
+        VectorType v;
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(static_cast<T>((i * 37) % 101));
+        }
+        std::vector<T> expected(v.begin(), v.end());
+
+        for (T value : {T(0), T(5), T(100), T(77), T(102)}) {
+            const auto it = std::find(expected.begin(), expected.end(), value);
+            assert(Find(v, value) - v.begin() == it - expected.begin());
+            assert(Contains(v, value) == (it != expected.end()));
+            assert(Count(v, value) == static_cast<size_t>(std::count(expected.begin(), expected.end(), value)));
+        }
+        assert(Sum(v) == std::accumulate(expected.begin(), expected.end(), vector_simd_detail::SumType<T>{}));
+        if (size > 0) {
+            const auto [min, max] = std::minmax_element(expected.begin(), expected.end());
+            assert(MinMax(v) == std::make_pair(*min, *max));
+        }
+
+        VectorType other = v;
+        assert(Compare(v, other) == 0);
+        if (size > 0) {
+            other[size - 1] = static_cast<T>(other[size - 1] + 1);
+            assert(Compare(v, other) < 0 && Compare(other, v) > 0);
+            other.PopBack();
+            assert(Compare(v, other) > 0);
+        }
+
+        Fill(v, T(7));
+        assert(Count(v, T(7)) == size && std::all_of(v.begin(), v.end(), [](T item) {
+            return item == T(7);
+        }));
+    }
+}
+
+void Test27() {
+    const SimdLevel supported = SupportedSimdLevel();
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > supported) {
+            break;
+        }
+        LimitSimdLevel(level);
+        assert(ActiveSimdLevel() == level);
+        CheckSimdAlgorithms<Vector<int8_t>>();
+        CheckSimdAlgorithms<Vector<uint8_t>>();
+        CheckSimdAlgorithms<Vector<int16_t>>();
+        CheckSimdAlgorithms<Vector<uint32_t>>();
+        CheckSimdAlgorithms<Vector<int64_t>>();
+        CheckSimdAlgorithms<Vector<double>>();
+        // Выровненный буфер без скалярного хвоста
+        CheckSimdAlgorithms<Vector<float, AlignedAllocator<float, 64>>>();
+        CheckSimdAlgorithms<Vector<int, AlignedAllocator<int, 64>>>();
+    }
+    LimitSimdLevel(supported);
+
+    // Счётчики однобайтных элементов не переполняются на длинных векторах
+    Vector<uint8_t> bytes(100000);
+    assert(Count(bytes, uint8_t{0}) == 100000 && Sum(bytes) == 0);
+    Fill(bytes, uint8_t{255});
+    assert(Sum(bytes) == 25500000u && MinMax(bytes) == std::make_pair(uint8_t{255}, uint8_t{255}));
+    bytes[99999] = 1;
+    assert(Find(bytes, uint8_t{1}) == bytes.end() - 1 && !Contains(bytes, uint8_t{2}));
+}
+
+#ifdef VECTOR_DEBUG_ITERATORS
+// Проверяет, что action аварийно завершает процесс, выполняя её в дочернем процессе
+template <typename Action>
+bool DiesWithDebugFailure(Action action) {
+    const pid_t child = fork();
+    if (child == 0) {
+        // Сообщение об ошибке ожидаемо, поэтому не выводится
+        std::freopen("/dev/null", "w", stderr);
+        action();
+        std::_Exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+#endif
+
+void Test28() {
+    {
+        Vector<int> v{1, 2, 3};
+        const Vector<int>& const_ref = v;
+        assert(v.At(0) == 1 && const_ref.At(2) == 3);
+        v.At(1) = 5;
+        assert(v[1] == 5);
+        bool thrown = false;
+        try {
+            const_ref.At(3);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+#ifdef VECTOR_DEBUG_ITERATORS
+    {
+        Vector<int> v{1, 2, 3};
+        v.Reserve(10);
+        // Добавление в конец без перевыделения и удаление с конца не делают итераторы недействительными
+        auto it = v.begin() + 1;
+        v.PushBack(4);
+        v.PopBack();
+        assert(*it == 2);
+        // Итератор, возвращённый Erase, действителен
+        it = v.Erase(it);
+        assert(*it == 3 && it + 1 == v.end());
+        Vector<int>::const_iterator const_it = it;
+        assert(const_it == it && const_it - v.cbegin() == 1);
+
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.begin();
+            v.Reserve(100);
+            [[maybe_unused]] int value = *stale;
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.begin() + 1;
+            v.Insert(v.begin(), 0);
+            [[maybe_unused]] bool equal = stale == v.end();
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            [[maybe_unused]] int value = *v.end();
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            [[maybe_unused]] auto outside = v.begin() + 3;
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            v.PopBack();
+            [[maybe_unused]] int value = v[1];
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            Vector<int> other = v;
+            v.Erase(other.begin());
+        }));
+        // Итераторы на разрушенные элементы недействительны, даже если на их месте уже новые элементы
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.begin();
+            v.Clear();
+            v.PushBack(7);
+            [[maybe_unused]] int value = *stale;
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.begin() + 1;
+            v.Resize(1);
+            v.Resize(2);
+            [[maybe_unused]] int value = *stale;
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.begin() + 1;
+            v.Resize(PARALLEL, 1);
+            v.PushBack(7);
+            [[maybe_unused]] int value = *stale;
+        }));
+        assert(DiesWithDebugFailure([&v] {
+            auto stale = v.end() - 1;
+            v.EraseUnordered(v.begin());
+            [[maybe_unused]] bool equal = stale == v.end();
+        }));
+        assert(DiesWithDebugFailure([] {
+            Vector<int>::iterator dangling;
+            {
+                Vector<int> temp{1};
+                dangling = temp.begin();
+            }
+            [[maybe_unused]] int value = *dangling;
+        }));
+    }
+#endif
+}
+
+struct GrowthTestTag {
+    static constexpr std::string_view NAME = "growth_test";
+};
+
+struct SampledGrowthTestTag {
+    static constexpr std::string_view NAME = "sampled_growth_test";
+};
+
+void Test29() {
+    GrowthSiteRegistry& registry = GrowthSiteRegistry::Instance();
+    registry.Clear();
+    {
+        using Stats = SamplingStats<GrowthTestTag, 1, CountingStats<GrowthTestTag>>;
+        Vector<int, std::allocator<int>, DoublingGrowth, Stats> v;
+        // Номер строки запоминается в той же строке, что и вызов
+        uint32_t push_line = 0;
+        for (int i = 0; i < 100; ++i) {
+            push_line = std::source_location::current().line(); v.PushBack(i);
+        }
+        // Перевыделения при размерах 0, 1, 2, 4, ..., 64
+        assert(CountingStats<GrowthTestTag>::Get().reallocations == 8);
+
+        v.ShrinkToFit();
+        const uint32_t emplace_line = std::source_location::current().line(); v.Emplace(v.begin(), 100);
+        v.Reserve(v.Size() + 10);
+        v.Emplace(v.begin(), 101);
+
+        const std::vector<GrowthSiteSample> samples = registry.Sample();
+        assert(samples.size() == 2);
+        const GrowthSiteSample& push = samples[0];
+        assert(push.name == "growth_test" && push.file == std::source_location::current().file_name());
+        assert(push.line == push_line && push.samples == 8 && push.estimated_events == 8 && push.max_size == 64);
+        assert(push.size_buckets[0] == 1 && push.size_buckets[1] == 1 && push.size_buckets[2] == 1);
+        assert(push.size_buckets[7] == 1 && push.size_buckets[8] == 0);
+        assert(samples[1].line == emplace_line && samples[1].samples == 1 && samples[1].max_size == 100);
+
+        std::ostringstream out;
+        registry.Write(out);
+        assert(out.str().find("samples=8 events~8 max_size=64\n    [0, 1) 1\n    [1, 2) 1\n") != std::string::npos);
+    }
+    registry.Clear();
+    {
+        // Рост при EmplaceBackAt учитывается в месте вызова, а не внутри vector.h
+        using Stats = SamplingStats<GrowthTestTag, 1>;
+        Vector<std::pair<int, int>, std::allocator<std::pair<int, int>>, DoublingGrowth, Stats> v;
+        uint32_t emplace_line = 0;
+        for (int i = 0; i < 10; ++i) {
+            emplace_line = std::source_location::current().line(); v.EmplaceBackAt(std::source_location::current(), i, i);
+        }
+        assert(v.Size() == 10 && v[9].second == 9);
+        const std::vector<GrowthSiteSample> samples = registry.Sample();
+        assert(samples.size() == 1 && samples[0].file == std::source_location::current().file_name());
+        assert(samples[0].line == emplace_line && samples[0].samples == 5);
+    }
+    registry.Clear();
+    {
+        // Записывается каждое четвёртое событие потока
+        using Stats = SamplingStats<SampledGrowthTestTag, 4>;
+        for (int round = 0; round < 4; ++round) {
+            Vector<int, std::allocator<int>, DoublingGrowth, Stats> v;
+            for (int i = 0; i < 5; ++i) {
+                v.PushBack(i);
+            }
+        }
+        const std::vector<GrowthSiteSample> samples = registry.Sample();
+        assert(samples.size() == 1 && samples[0].samples == 4 && samples[0].estimated_events == 16);
+    }
+    registry.Clear();
+}
+
+void Test30() {
+    static_assert(vector_detail::MOVES_WITH_ROLLBACK<RollbackObj>);
+    const auto has_sequential_ids = [](const Vector<RollbackObj>& v) {
+        for (size_t i = 0; i < v.Size(); ++i) {
+            if (v[i].id != static_cast<int>(i)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    RollbackObj::ResetCounters();
+    {
+        const size_t SIZE = 10;
+        Vector<RollbackObj> v;
+        v.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        // Элементы перемещаются, а не копируются
+        v.Reserve(SIZE * 2);
+        assert(RollbackObj::num_moved == static_cast<int>(SIZE) && RollbackObj::num_copied == 0);
+
+        // Перемещённые до исключения элементы возвращаются на место
+        RollbackObj::throw_on_move_id = 7;
+        RollbackObj::num_moved = 0;
+        try {
+            v.Reserve(SIZE * 4);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == SIZE * 2 && has_sequential_ids(v));
+        assert(RollbackObj::num_moved == 7 && RollbackObj::num_move_assigned == 7);
+        assert(RollbackObj::num_alive == static_cast<int>(SIZE) && RollbackObj::num_copied == 0);
+
+        // Вставка с перевыделением: откатываются обе части вокруг нового элемента
+        while (v.Size() < v.Capacity()) {
+            v.EmplaceBack(static_cast<int>(v.Size()));
+        }
+        const size_t full_size = v.Size();
+        try {
+            v.Emplace(v.begin() + 3, 100);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == full_size && v.Capacity() == full_size && has_sequential_ids(v));
+        assert(RollbackObj::num_alive == static_cast<int>(full_size));
+        const RollbackObj extra[] = {RollbackObj(200), RollbackObj(201)};
+        try {
+            v.Insert(v.begin() + 9, std::begin(extra), std::end(extra));
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == full_size && has_sequential_ids(v));
+        assert(RollbackObj::num_alive == static_cast<int>(full_size + 2) && RollbackObj::num_copied == 2);
+
+        RollbackObj::throw_on_move_id = -1;
+        v.Emplace(v.begin() + 3, 100);
+        assert(v.Size() == full_size + 1 && v[3].id == 100 && v[4].id == 3);
+    }
+    assert(RollbackObj::num_alive == 0);
+    RollbackObj::ResetCounters();
+    {
+        // Параллельный перенос откатывает и завершившиеся фрагменты
+        const size_t SIZE = 100000;
+        Vector<RollbackObj> v;
+        v.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        RollbackObj::throw_on_move_id = static_cast<int>(SIZE / 2 + 10);
+        try {
+            v.Reserve(ParallelTag{4}, SIZE * 2);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == SIZE && has_sequential_ids(v));
+        assert(RollbackObj::num_alive == static_cast<int>(SIZE) && RollbackObj::num_copied == 0);
+        RollbackObj::throw_on_move_id = -1;
+        v.Reserve(ParallelTag{4}, SIZE * 2);
+        assert(v.Capacity() == SIZE * 2 && has_sequential_ids(v));
+    }
+    RollbackObj::ResetCounters();
+    {
+        // Столбец SoaVector, перемещённый до исключения в другом столбце, тоже возвращается
+        SoaVector<RollbackObj, RollbackObj> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(RollbackObj(i), RollbackObj(i + 10));
+        }
+        RollbackObj::throw_on_move_id = 12;
+        try {
+            v.Reserve(8);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            assert(v.Get<0>(i).id == static_cast<int>(i) && v.Get<1>(i).id == static_cast<int>(i + 10));
+        }
+        assert(RollbackObj::num_alive == 8 && RollbackObj::num_copied == 0);
+    }
+    assert(RollbackObj::num_alive == 0);
+}
+
+// Простые числа меньше Limit, найденные решетом во время компиляции
+template <int Limit>
+constexpr Vector<int> BuildPrimes() {
+    const int limit = Limit;
+    Vector<bool> composite(static_cast<size_t>(limit));
+    Vector<int> primes;
+    for (int i = 2; i < limit; ++i) {
+        if (composite[i]) {
+            continue;
+        }
+        primes.PushBack(i);
+        for (int j = i * i; j < limit; j += i) {
+            composite[j] = true;
+        }
+    }
+    return primes;
+}
+
+// Нетривиально перемещаемый тип, допустимый в константных выражениях
+struct ConstexprItem {
+    constexpr ConstexprItem(int value = 0) noexcept
+        : value(value) {
+    }
+    constexpr ConstexprItem(const ConstexprItem& other) noexcept
+        : value(other.value) {
+    }
+    constexpr ConstexprItem& operator=(const ConstexprItem& other) noexcept {
+        value = other.value;
+        return *this;
+    }
+    constexpr ~ConstexprItem() {
+    }
+    constexpr operator int() const noexcept {
+        return value;
+    }
+    int value;
+};
+
+template <typename Item>
+constexpr uint32_t ConstexprOperationsChecksum() {
+    Vector<Item> v = {Item(5), Item(6), Item(7)};
+    v.Reserve(4);
+    for (int i = 0; i < 10; ++i) {
+        v.PushBack(Item(i));
+    }
+    v.Insert(v.begin() + 1, Item(100));
+    v.Insert(v.begin(), Item(v[2]));
+    v.Emplace(v.begin() + 4, 200);
+    v.Erase(v.begin() + 3);
+    v.Erase(v.begin() + 5, v.begin() + 8);
+    v.EraseUnordered(v.begin());
+    const Item extra[] = {Item(-1), Item(-2)};
+    v.Insert(v.begin() + 2, std::begin(extra), std::end(extra));
+    v.Resize(v.Size() + 2);
+    v.ShrinkToFit();
+    Vector<Item> copy;
+    copy = v;
+    Vector<Item> moved(std::move(copy));
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < moved.Size(); ++i) {
+        checksum = checksum * 31 + static_cast<uint32_t>(static_cast<int>(moved[i]));
+    }
+    return checksum + static_cast<uint32_t>(moved.Size() * 1000 + copy.Size());
+}
+
+void Test31() {
+    const Vector<int> primes = BuildPrimes<50>();
+    assert(primes.Size() == 15 && primes[0] == 2 && primes[14] == 47);
+    const uint32_t runtime_checksum = ConstexprOperationsChecksum<int>();
+    assert(ConstexprOperationsChecksum<ConstexprItem>() == runtime_checksum);
+#ifndef VECTOR_DEBUG_ITERATORS
+    // Таблица, построенная во время компиляции, совпадает с построенной во время выполнения
+    constexpr auto PRIMES = ToArray<BuildPrimes<50>().Size()>(BuildPrimes<50>());
+    static_assert(PRIMES.size() == 15 && PRIMES[0] == 2 && PRIMES[14] == 47);
+    assert(std::equal(primes.begin(), primes.end(), PRIMES.begin()));
+    // Как для тривиально перемещаемых элементов, так и для остальных
+    static_assert(ConstexprOperationsChecksum<int>() == ConstexprOperationsChecksum<ConstexprItem>());
+    constexpr uint32_t CHECKSUM = ConstexprOperationsChecksum<int>();
+    assert(CHECKSUM == runtime_checksum);
+#endif
+}
+
+void Test32() {
+    const int ID = 42;
+    const size_t CAPACITY = 4;
+    {
+        Obj::ResetCounters();
+        StaticVector<Obj, CAPACITY> v;
+        static_assert(StaticVector<Obj, CAPACITY>::Capacity() == CAPACITY);
+        // Элементы лежат внутри самого вектора
+        const auto* self = reinterpret_cast<const std::byte*>(&v);
+        const auto* data = reinterpret_cast<const std::byte*>(v.GetAddress());
+        assert(data >= self && data + CAPACITY * sizeof(Obj) <= self + sizeof(v));
+
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            Obj* item = v.TryEmplaceBack(ID + static_cast<int>(i));
+            assert(item == &v[i] && item->id == ID + static_cast<int>(i));
+        }
+        assert(v.IsFull());
+        // В заполненном векторе элемент не конструируется
+        assert(v.TryEmplaceBack(ID) == nullptr && !v.TryPushBack(Obj(ID)));
+        assert(Obj::num_constructed_with_id == static_cast<int>(CAPACITY) + 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(CAPACITY));
+        try {
+            v.EmplaceBack(ID);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.Insert(v.begin(), Obj(ID));
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == CAPACITY && Obj::GetAliveObjectCount() == static_cast<int>(CAPACITY));
+
+        v.Erase(v.begin() + 1);
+        v.Emplace(v.begin(), ID - 1);
+        assert(v[0].id == ID - 1 && v[1].id == ID && v[2].id == ID + 2 && v[3].id == ID + 3);
+        v.Erase(v.begin() + 1, v.begin() + 3);
+        v.EraseUnordered(v.begin());
+        assert(v.Size() == 1 && v[0].id == ID + 3);
+
+        StaticVector<Obj, CAPACITY> other(3);
+        other[2].id = ID;
+        v.Swap(other);
+        assert(v.Size() == 3 && v[2].id == ID && other.Size() == 1 && other[0].id == ID + 3);
+        StaticVector<Obj, CAPACITY> moved(std::move(v));
+        assert(moved.Size() == 3 && v.Size() == 0);
+        v = moved;
+        assert(v.Size() == 3 && v[2].id == ID);
+        assert(v.EraseIf([](const Obj& obj) { return obj.id == 0; }) == 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size() + moved.Size() + other.Size()));
+        // Перемещающее присваивание, как и конструктор, оставляет источник пустым
+        other = std::move(moved);
+        assert(other.Size() == 3 && other[2].id == ID && moved.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(v.Size() + other.Size()));
+        try {
+            v.Resize(CAPACITY + 1);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        StaticVector<std::string, CAPACITY> v = {"a", "b"};
+        const std::string extra[] = {"c", "d", "e"};
+        try {
+            v.Insert(v.begin() + 1, std::begin(extra), std::end(extra));
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        assert(v.Size() == 2);
+        v.Insert(v.begin() + 1, std::begin(extra), std::begin(extra) + 2);
+        assert(v[0] == "a" && v[1] == "c" && v[2] == "d" && v[3] == "b");
+        assert(v.At(3) == "b");
+    }
+}
+
+template <typename SearchPolicy>
+void CheckFlatContainers() {
+    {
+        FlatSet<int, std::less<int>, SearchPolicy> set = {5, 1, 3, 3};
+        assert(set.Size() == 3 && set.Contains(1) && !set.Contains(2) && *set.LowerBound(2) == 3);
+        assert(set.Find(4) == set.end() && set.LowerBound(6) == set.end());
+        assert(set.Insert(2).second && !set.Insert(2).second);
+        assert(set.Erase(3) == 1 && set.Erase(3) == 0);
+        assert((set == FlatSet<int, std::less<int>, SearchPolicy>{1, 2, 5}));
+
+        // Пакет с повторами внутри и с уже имеющимися ключами
+        const int sorted[] = {0, 2, 2, 4, 6, 6};
+        set.InsertSorted(std::begin(sorted), std::end(sorted));
+        assert((set == FlatSet<int, std::less<int>, SearchPolicy>{0, 1, 2, 4, 5, 6}));
+        FlatSet<int, std::less<int>, SearchPolicy> other = {7, -1, 4};
+        set.Merge(std::move(other));
+        assert(other.Size() == 0 && set.Size() == 8 && *set.begin() == -1 && set.Contains(7));
+        assert(set.EraseIf([](int key) { return key % 2 != 0; }) == 4);
+        assert((set == FlatSet<int, std::less<int>, SearchPolicy>{0, 2, 4, 6}));
+
+        FlatSet<int, std::greater<int>, SearchPolicy> descending = {1, 3, 2};
+        assert(*descending.begin() == 3 && descending.Contains(1) && *descending.LowerBound(5) == 3);
+    }
+    {
+        // Сверяем со std::map на случайных пакетах и одиночных операциях
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> keys(0, 5000);
+        FlatMap<int, std::string, std::less<int>, SearchPolicy> map;
+        std::map<int, std::string> expected;
+        for (int round = 0; round < 20; ++round) {
+            std::vector<std::pair<int, std::string>> batch;
+            for (int i = 0; i < 200; ++i) {
+                const int key = keys(generator);
+                batch.emplace_back(key, std::to_string(round));
+            }
+            std::stable_sort(batch.begin(), batch.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+            if (round % 2 == 0) {
+                map.InsertSorted(batch.begin(), batch.end());
+            } else {
+                std::shuffle(batch.begin(), batch.end(), generator);
+                std::stable_sort(batch.begin(), batch.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.first < rhs.first;
+                });
+                map.Insert(batch.begin(), batch.end());
+            }
+            expected.insert(batch.begin(), batch.end());
+            const int key = keys(generator);
+            assert(map.Erase(key) == expected.erase(key));
+            map[key + 1] = "single";
+            expected[key + 1] = "single";
+            assert(map.Size() == expected.size());
+            assert(std::equal(map.begin(), map.end(), expected.begin(), expected.end(),
+                [](const auto& lhs, const auto& rhs) {
+                    return lhs.first == rhs.first && lhs.second == rhs.second;
+                }));
+        }
+        for (int key = -1; key <= 5001; ++key) {
+            const auto it = expected.find(key);
+            assert(map.Contains(key) == (it != expected.end()));
+            if (it != expected.end()) {
+                assert(map.At(key) == it->second && map.Find(key)->second == it->second);
+            }
+            const auto lower = expected.lower_bound(key);
+            assert(lower == expected.end() ? map.LowerBound(key) == map.end() : map.LowerBound(key)->first == lower->first);
+        }
+        try {
+            map.At(-1);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        assert(!map.TryEmplace(map.begin()->first, "ignored").second);
+        assert(map.TryEmplace(-1, 3, 'x').second && map.At(-1) == "xxx");
+
+        // Ключи через итераторы не меняются, а значения FlatMap меняются
+        using Map = FlatMap<int, std::string, std::less<int>, SearchPolicy>;
+        using Set = FlatSet<int, std::less<int>, SearchPolicy>;
+        static_assert(!std::is_assignable_v<decltype(*std::declval<Set&>().begin()), int>);
+        static_assert(!std::is_assignable_v<decltype((std::declval<Map&>().begin()->first)), int>);
+        static_assert(std::is_assignable_v<decltype((std::declval<Map&>().begin()->second)), std::string>);
+        static_assert(std::is_convertible_v<typename Map::iterator, typename Map::const_iterator>);
+        map.Find(-1)->second = "yyy";
+        auto [key, value] = *map.begin();
+        value += "z";
+        assert(key == -1 && map.At(-1) == "yyyz");
+        const Map& const_map = map;
+        assert(const_map.Find(-1) == map.begin());
+        assert(const_map.end() - map.begin() == static_cast<std::ptrdiff_t>(map.Size()));
+    }
+}
+
+// Ключ, копирование и сравнение которого бросают исключение после заданного числа операций
+struct FragileKey {
+    static inline int operations_left = -1;
+
+    static void Tick() {
+        if (operations_left == 0) {
+            throw std::runtime_error("fragile key");
+        }
+        if (operations_left > 0) {
+            --operations_left;
+        }
+    }
+
+    explicit FragileKey(int value)
+        : value(value) {
+    }
+
+    FragileKey(const FragileKey& other)
+        : value(other.value) {
+        Tick();
+    }
+
+    FragileKey& operator=(const FragileKey& other) {
+        Tick();
+        value = other.value;
+        return *this;
+    }
+
+    friend bool operator<(const FragileKey& lhs, const FragileKey& rhs) {
+        Tick();
+        return lhs.value < rhs.value;
+    }
+
+    int value;
+};
+
+// Исключение при вставке пакета оставляет контейнер упорядоченным, а индекс — актуальным
+template <typename SearchPolicy>
+void CheckFlatExceptionSafety(bool sorted_batch) {
+    for (int operations = 0;; ++operations) {
+        FlatSet<FragileKey, std::less<FragileKey>, SearchPolicy> set;
+        for (int i = 0; i < 20; i += 2) {
+            set.Insert(FragileKey(i));
+        }
+        std::vector<FragileKey> batch;
+        for (int i = 0; i < 25; i += 3) {
+            batch.emplace_back(sorted_batch ? i : 24 - i);
+        }
+        FragileKey::operations_left = operations;
+        bool thrown = false;
+        try {
+            if (sorted_batch) {
+                set.InsertSorted(batch.begin(), batch.end());
+            } else {
+                set.Insert(batch.begin(), batch.end());
+            }
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        FragileKey::operations_left = -1;
+        assert(std::is_sorted(set.begin(), set.end()));
+        for (const FragileKey& key : set) {
+            assert(set.Contains(key));
+        }
+        if (!thrown) {
+            assert(set.Size() == 15);
+            break;
+        }
+        // Прежние элементы либо сохранены, либо контейнер очищен
+        assert(set.Size() == 10 || set.Size() == 0);
+        assert(set.Size() == 0 || set.Contains(FragileKey(18)));
+    }
+}
+
+void Test33() {
+    CheckFlatContainers<BranchlessSearch>();
+    CheckFlatContainers<EytzingerSearch>();
+    CheckFlatExceptionSafety<BranchlessSearch>(true);
+    CheckFlatExceptionSafety<BranchlessSearch>(false);
+    CheckFlatExceptionSafety<EytzingerSearch>(true);
+    CheckFlatExceptionSafety<EytzingerSearch>(false);
+    {
+        // Слияние с собой ничего не меняет
+        FlatSet<int> set = {3, 1, 2};
+        set.Merge(set);
+        set.Merge(std::move(set));
+        assert((set == FlatSet<int>{1, 2, 3}));
+    }
+    {
+        // Пакет добавляется одной вставкой диапазона: не более одного перевыделения
+        FlatSet<int> set;
+        std::vector<int> batch(1000);
+        std::iota(batch.begin(), batch.end(), 0);
+        set.InsertSorted(batch.begin(), batch.end());
+        assert(set.Size() == batch.size() && set.Capacity() == batch.size());
+    }
+}
+
+void Test34() {
+    ReleaseThreadPool();
+    ResetThreadPoolStatistics();
+    // Векторы похожих размеров, создаваемые и разрушаемые подряд, получают один и тот же блок
+    const int* first_data = nullptr;
+    for (int i = 0; i < 100; ++i) {
+        PooledVector<int> v;
+        for (int j = 0; j < 20 + i % 5; ++j) {
+            v.PushBack(j);
+        }
+        // Блок выделяется целым классом размера: 16 элементов в 64 байтах, затем 32 в 128
+        assert(v.Capacity() == 32);
+        if (first_data == nullptr) {
+            first_data = v.GetAddress();
+        }
+        assert(v.GetAddress() == first_data);
+    }
+    {
+        const PoolStatistics stats = GetThreadPoolStatistics();
+        // Промахи только в первой итерации, далее оба блока берутся из пула
+        assert(stats.misses == 2 && stats.hits == 2 * 100 - 2 && stats.overflows == 0);
+        assert(stats.retained_blocks == 2 && stats.retained_bytes == 64 + 128);
+    }
+
+    // Удержание ограничено числом блоков класса и объёмом
+    ReleaseThreadPool();
+    ResetThreadPoolStatistics();
+    SetThreadPoolLimits({.max_blocks_per_class = 2, .max_retained_bytes = 1024});
+    {
+        // Разрушаются в обратном порядке: сначала блоки по 128 байт, затем на 1024 байта
+        PooledVector<char> large(1000);
+        std::vector<PooledVector<char>> vectors;
+        for (int i = 0; i < 4; ++i) {
+            vectors.emplace_back(100);
+        }
+    }
+    {
+        // Два блока по 128 байт не поместились по числу, блок на 1024 байта — по объёму
+        const PoolStatistics stats = GetThreadPoolStatistics();
+        assert(stats.misses == 1 + 4 && stats.overflows == 2 + 1);
+        assert(stats.retained_blocks == 2 && stats.retained_bytes == 2 * 128);
+    }
+    SetThreadPoolLimits({.max_blocks_per_class = 1, .max_retained_bytes = 128});
+    assert(GetThreadPoolStatistics().retained_bytes <= 128);
+    SetThreadPoolLimits(PoolLimits{});
+
+    // Крупные блоки и типы со строгим выравниванием обходят пул
+    ResetThreadPoolStatistics();
+    {
+        PooledVector<char> huge(POOL_MAX_BLOCK_BYTES + 1);
+        assert(huge.Capacity() == POOL_MAX_BLOCK_BYTES + 1);
+        struct alignas(64) Wide {
+            char data[64];
+        };
+        PooledVector<Wide> wide(3);
+        assert(reinterpret_cast<uintptr_t>(wide.GetAddress()) % 64 == 0);
+    }
+    assert(GetThreadPoolStatistics().misses == 0 && GetThreadPoolStatistics().hits == 0);
+
+    // У каждого потока свой пул, а блок, освобождённый в другом потоке, попадает в его пул
+    PooledVector<int> shared(10);
+    std::thread worker([&shared] {
+        assert(GetThreadPoolStatistics().retained_blocks == 0);
+        PooledVector<int> local(std::move(shared));
+        for (int i = 0; i < 10; ++i) {
+            PooledVector<int> v(5);
+        }
+        assert(GetThreadPoolStatistics().misses == 1 && GetThreadPoolStatistics().hits == 9);
+    });
+    worker.join();
+    assert(shared.Size() == 0);
+    ReleaseThreadPool();
+    assert(GetThreadPoolStatistics().retained_blocks == 0);
+}
+
+// Аргументы, указывающие в сдвигаемые элементы, читаются до сдвига хвоста
+template <typename Container>
+void CheckEmplaceFromAliasedArguments(Container& v) {
+    v.EmplaceBack("abc");
+    v.EmplaceBack("def");
+    v.Emplace(v.begin(), v[1].c_str());
+    assert(v.Size() == 3 && v[0] == "def" && v[1] == "abc" && v[2] == "def");
+    v.Emplace(v.begin() + 1, std::string_view(v[2]));
+    assert(v.Size() == 4 && v[0] == "def" && v[1] == "def" && v[2] == "abc" && v[3] == "def");
+    v.Emplace(v.begin(), v[2].begin(), v[2].end());
+    assert(v.Size() == 5 && v[0] == "abc" && v[3] == "abc");
+}
+
+void Test35() {
+    {
+        Vector<std::string> v;
+        v.Reserve(8);
+        CheckEmplaceFromAliasedArguments(v);
+    }
+    {
+        StaticVector<std::string, 8> v;
+        CheckEmplaceFromAliasedArguments(v);
+    }
+    {
+        SmallVector<std::string, 8> v;
+        CheckEmplaceFromAliasedArguments(v);
+    }
+}
+
+struct C {
+    C() noexcept {
+        ++def_ctor;
+    }
+    C(const C& /*other*/) noexcept {
+        ++copy_ctor;
+    }
+    C(C&& /*other*/) noexcept {
+        ++move_ctor;
+    }
+    C& operator=(const C& other) noexcept {
+        if (this != &other) {
+            ++copy_assign;
+        }
+        return *this;
+    }
+    C& operator=(C&& /*other*/) noexcept {
+        ++move_assign;
+        return *this;
+    }
+    ~C() {
+        ++dtor;
+    }
+
+    static void Reset() {
+        def_ctor = 0;
+        copy_ctor = 0;
+        move_ctor = 0;
+        copy_assign = 0;
+        move_assign = 0;
+        dtor = 0;
+    }
+
+    inline static size_t def_ctor = 0;
+    inline static size_t copy_ctor = 0;
+    inline static size_t move_ctor = 0;
+    inline static size_t copy_assign = 0;
+    inline static size_t move_assign = 0;
+    inline static size_t dtor = 0;
+};
+
+void Dump() {
+    using namespace std;
+    cerr << "Def ctors: "sv << C::def_ctor              //
+         << ", Copy ctors: "sv << C::copy_ctor          //
+         << ", Move ctors: "sv << C::move_ctor          //
+         << ", Copy assignments: "sv << C::copy_assign  //
+         << ", Move assignments: "sv << C::move_assign  //
+         << ", Dtors: "sv << C::dtor << endl;
+}
+
+void Benchmark() {
+    using namespace std;
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "std::vector:"sv << endl;
+            C::Reset();
+            vector<C> v(NUM);
+            Dump();
+            v.push_back(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "Vector:"sv << endl;
+            C::Reset();
+            Vector<C> v(NUM);
+            Dump();
+            v.PushBack(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "std::vector:"sv << endl;
+            C::Reset();
+            vector<C> v(NUM);
+            v.reserve(NUM * 2);
+            Dump();
+            v.push_back(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+    try {
+        const size_t NUM = 10;
+        C c;
+        {
+            cerr << "Vector:"sv << endl;
+            C::Reset();
+            Vector<C> v(NUM);
+            v.Reserve(NUM * 2);
+            Dump();
+            v.PushBack(c);
+        }
+        Dump();
+    } catch (...) {
+    }
+}
+
+// Нагрузочный стенд: каждый из N потоков выполняет свою смесь операций над векторами,
+// а стенд измеряет пропускную способность при росте числа потоков от 1 до max_threads
+// и задержки отдельных операций (p50/p99/p999). Задержка операций, выделяющих память,
+// выводится отдельно: её рост с числом потоков показывает конкуренцию в аллокаторе.
+// Полный прогон: main --stress [max_threads] [ops_per_thread]. При обычном запуске тестов
+// выполняется короткий прогон на одном и двух потоках без вывода
+struct StressOptions {
+    size_t max_threads = 64;
+    size_t ops_per_thread = 200'000;
+    bool verbose = true;
+};
+
+struct StressThreadResult {
+    // Задержки всех операций и операций, выделяющих память, в наносекундах
+    Vector<uint32_t> latencies;
+    Vector<uint32_t> alloc_latencies;
+    PoolStatistics pool;
+    uint64_t checksum = 0;
+};
+
+// Выполняет op и записывает её длительность. Память под замеры выделена заранее
+template <typename Op>
+uint32_t TimeOperation(Vector<uint32_t>& latencies, Op&& op) {
+    const auto start = std::chrono::steady_clock::now();
+    op();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    const uint32_t latency = static_cast<uint32_t>(std::min<int64_t>(nanoseconds, UINT32_MAX));
+    latencies.PushBack(latency);
+    return latency;
+}
+
+uint32_t Percentile(Vector<uint32_t>& samples, double quantile) {
+    if (samples.Size() == 0) {
+        return 0;
+    }
+    const size_t rank = std::min(samples.Size() - 1, static_cast<size_t>(quantile * samples.Size()));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+// Смесь операций над собственным вектором потока: EmplaceBack, Erase из середины,
+// ShrinkToFit с последующим Reserve и копирование. Размер вектора ограничен MAX_SIZE
+template <typename VectorType>
+void RunVectorWorkload(size_t thread_index, size_t ops, StressThreadResult& result) {
+    const size_t MAX_SIZE = 1024;
+    std::minstd_rand generator(static_cast<uint32_t>(thread_index + 1));
+    VectorType v;
+    for (size_t i = 0; i < ops; ++i) {
+        const uint32_t dice = generator() % 100;
+        if (dice < 50 && v.Size() < MAX_SIZE) {
+            TimeOperation(result.latencies, [&] {
+                v.EmplaceBack(static_cast<int64_t>(i));
+            });
+        } else if (dice < 75 && v.Size() != 0) {
+            const size_t index = generator() % v.Size();
+            TimeOperation(result.latencies, [&] {
+                v.Erase(v.begin() + index);
+            });
+        } else if (dice < 85) {
+            result.alloc_latencies.PushBack(TimeOperation(result.latencies, [&] {
+                v.ShrinkToFit();
+                v.Reserve(v.Size() + v.Size() / 2 + 1);
+            }));
+        } else {
+            result.alloc_latencies.PushBack(TimeOperation(result.latencies, [&] {
+                const VectorType copy(v);
+                result.checksum += copy.Size() != 0 ? static_cast<uint64_t>(copy[copy.Size() / 2]) : 0;
+            }));
+        }
+    }
+    result.checksum += v.Size();
+}
+
+// Все потоки добавляют элементы в общий ConcurrentVector и читают добавленные ими ранее
+void RunConcurrentWorkload(ConcurrentVector<int64_t>& shared, size_t ops, StressThreadResult& result) {
+    Vector<int64_t*> own;
+    own.Reserve(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        if (i % 4 != 3) {
+            TimeOperation(result.latencies, [&] {
+                own.PushBack(&shared.EmplaceBack(static_cast<int64_t>(i)));
+            });
+        } else {
+            TimeOperation(result.latencies, [&] {
+                result.checksum += static_cast<uint64_t>(*own[i % own.Size()]);
+            });
+        }
+    }
+}
+
+// Запускает threads потоков, одновременно начинающих workload(thread_index, result),
+// и возвращает время в секундах от старта до завершения последнего потока
+template <typename Workload>
+double RunStressThreads(size_t threads, size_t ops, Vector<StressThreadResult>& results, const Workload& workload) {
+    results = Vector<StressThreadResult>(threads);
+    for (StressThreadResult& result : results) {
+        result.latencies.Reserve(ops);
+        result.alloc_latencies.Reserve(ops);
+    }
+    std::latch start(static_cast<std::ptrdiff_t>(threads) + 1);
+    Vector<std::thread> workers;
+    workers.Reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.EmplaceBack([&, i] {
+            start.arrive_and_wait();
+            workload(i, results[i]);
+            results[i].pool = GetThreadPoolStatistics();
+        });
+    }
+    start.arrive_and_wait();
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Контрольная сумма операций записывается сюда, чтобы компилятор их не выбросил
+volatile uint64_t stress_checksum_sink = 0;
+
+// Сводит результаты потоков в строку таблицы и возвращает пропускную способность.
+// Ускорение считается относительно пропускной способности на одном потоке
+double ReportStressRun(std::string_view name, size_t threads, double seconds,
+        Vector<StressThreadResult>& results, double base_throughput, bool verbose) {
+    Vector<uint32_t> latencies;
+    Vector<uint32_t> alloc_latencies;
+    size_t pool_hits = 0;
+    size_t pool_misses = 0;
+    uint64_t checksum = 0;
+    for (StressThreadResult& result : results) {
+        latencies.AppendRange(result.latencies);
+        alloc_latencies.AppendRange(result.alloc_latencies);
+        pool_hits += result.pool.hits;
+        pool_misses += result.pool.misses;
+        checksum += result.checksum;
+    }
+    const double throughput = static_cast<double>(latencies.Size()) / seconds;
+    const double speedup = threads == 1 ? 1.0 : throughput / base_throughput;
+    if (verbose) {
+        using namespace std;
+        cerr << left << setw(18) << name << right << setw(8) << threads
+             << setw(14) << fixed << setprecision(0) << throughput
+             << setw(9) << setprecision(2) << speedup
+             << setw(10) << setprecision(0) << 100 * speedup / static_cast<double>(threads) << '%'
+             << setw(8) << Percentile(latencies, 0.5)
+             << setw(8) << Percentile(latencies, 0.99)
+             << setw(8) << Percentile(latencies, 0.999)
+             << setw(11) << Percentile(alloc_latencies, 0.99);
+        if (pool_hits + pool_misses != 0) {
+            cerr << setw(9) << setprecision(1)
+                 << 100.0 * static_cast<double>(pool_hits) / static_cast<double>(pool_hits + pool_misses) << '%';
+        }
+        cerr << defaultfloat << endl;
+    }
+    stress_checksum_sink = checksum;
+    return throughput;
+}
+
+void StressBenchmark(const StressOptions& options) {
+    using namespace std::literals;
+    Vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < options.max_threads; threads *= 2) {
+        thread_counts.PushBack(threads);
+    }
+    thread_counts.PushBack(options.max_threads);
+    if (options.verbose) {
+        using namespace std;
+        cerr << "Stress: "sv << options.ops_per_thread << " ops per thread, "sv
+             << thread::hardware_concurrency() << " hardware threads, latencies in ns"sv << endl;
+        cerr << left << setw(18) << "workload"sv << right << setw(8) << "threads"sv << setw(14) << "ops/s"sv
+             << setw(9) << "speedup"sv << setw(11) << "efficiency"sv << setw(8) << "p50"sv << setw(8) << "p99"sv
+             << setw(8) << "p999"sv << setw(11) << "alloc p99"sv << setw(10) << "pool hits"sv << endl;
+    }
+    const size_t ops = options.ops_per_thread;
+    Vector<StressThreadResult> results;
+    // prepare вызывается перед прогоном на каждом числе потоков
+    const auto run_scaling = [&](std::string_view name, const auto& prepare, const auto& workload) {
+        double base_throughput = 0;
+        for (size_t threads : thread_counts) {
+            prepare();
+            const double seconds = RunStressThreads(threads, ops, results, workload);
+            const double throughput = ReportStressRun(name, threads, seconds, results, base_throughput,
+                options.verbose);
+            if (threads == 1) {
+                base_throughput = throughput;
+            }
+        }
+    };
+    const auto no_prepare = [] {};
+    run_scaling("Vector"sv, no_prepare, [ops](size_t thread_index, StressThreadResult& result) {
+        RunVectorWorkload<Vector<int64_t>>(thread_index, ops, result);
+    });
+    run_scaling("PooledVector"sv, no_prepare, [ops](size_t thread_index, StressThreadResult& result) {
+        ResetThreadPoolStatistics();
+        RunVectorWorkload<PooledVector<int64_t>>(thread_index, ops, result);
+    });
+    std::unique_ptr<ConcurrentVector<int64_t>> shared;
+    run_scaling("ConcurrentVector"sv, [&shared] {
+        shared = std::make_unique<ConcurrentVector<int64_t>>();
+    }, [ops, &shared](size_t /*thread_index*/, StressThreadResult& result) {
+        RunConcurrentWorkload(*shared, ops, result);
+    });
+    // Каждая четвёртая операция — чтение
+    assert(shared->Size() == (ops - ops / 4) * options.max_threads);
+}
+
+// Положительное число из аргумента командной строки name
+size_t ParseStressCount(std::string_view text, std::string_view name) {
+    size_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || value == 0) {
+        throw std::invalid_argument(std::string(name) + " must be a positive integer, got '" + std::string(text) + "'");
+    }
+    return value;
+}
+
+int main(int argc, char* argv[]) {
+    using namespace std::literals;
+    if (argc > 1 && argv[1] == "--stress"sv) {
+        StressOptions options;
+        try {
+            options.max_threads = argc > 2 ? ParseStressCount(argv[2], "max_threads")
+                                           : std::max(std::thread::hardware_concurrency(), 1u);
+            if (argc > 3) {
+                options.ops_per_thread = ParseStressCount(argv[3], "ops");
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << "\nusage: " << argv[0] << " --stress [max_threads] [ops]" << std::endl;
+            return 1;
+        }
+        try {
+            StressBenchmark(options);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
     try {
         Test1();
         Test2();
@@ -676,7 +3201,37 @@ int main() {
         Test4();
         Test5();
         Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
         Benchmark();
+        StressBenchmark({.max_threads = 2, .ops_per_thread = 2'000, .verbose = false});
         std::cerr << "success" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
@@ -0,0 +1,239 @@
+#pragma once
+#include "vector.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+// Вектор тривиально копируемых элементов, хранящихся в отображённом в память файле.
+// Файл начинается с заголовка (сигнатура, размер элемента, число элементов), за которым
+// идут сами элементы. Повторное открытие файла не копирует данные: элементы читаются
+// прямо из страничного кеша, который разделяется между процессами.
+// Вместимость определяется размером файла и растёт через ftruncate и mremap, поэтому
+// любое расширение может переместить отображение и сделать недействительными
+// указатели на элементы
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+class MmapVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MmapVector stores only trivially copyable types");
+    static_assert(alignof(T) <= 64, "Element alignment must not exceed the header size");
+
+public:
+    MmapVector() = default;
+
+    // Открывает файл path, создавая пустой вектор, если файла нет или он пуст
+    static MmapVector Open(const std::string& path) {
+        MmapVector result;
+        result.fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (result.fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        struct stat file_stat {};
+        if (fstat(result.fd_, &file_stat) != 0) {
+            ThrowSystemError("fstat");
+        }
+        const size_t file_bytes = static_cast<size_t>(file_stat.st_size);
+        if (file_bytes == 0) {
+            result.Map(HEADER_SIZE, true);
+            *result.header_ = Header{};
+        } else {
+            if (file_bytes < HEADER_SIZE) {
+                throw std::runtime_error("MmapVector: file is too short");
+            }
+            result.Map(file_bytes, false);
+            result.Validate();
+        }
+        return result;
+    }
+
+    MmapVector(const MmapVector&) = delete;
+    MmapVector& operator=(const MmapVector&) = delete;
+
+    MmapVector(MmapVector&& other) noexcept {
+        Swap(other);
+    }
+
+    MmapVector& operator=(MmapVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MmapVector temp(std::move(rhs));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    // Закрывает файл. Изменения попадают в файл и без Sync, но без гарантии сохранности
+    // при сбое системы
+    ~MmapVector() {
+        if (header_ != nullptr) {
+            munmap(header_, mapped_bytes_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    void Swap(MmapVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(header_, other.header_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+    }
+
+    bool IsOpen() const noexcept {
+        return header_ != nullptr;
+    }
+
+    // Синхронно записывает отображение на диск
+    void Sync() {
+        if (header_ != nullptr && msync(header_, mapped_bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    // Вектор без открытого файла пуст, и расширить его нельзя
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            CheckOpen();
+            Map(HEADER_SIZE + new_capacity * sizeof(T), true);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (!IsOpen() && new_size == 0) {
+            return;
+        }
+        CheckOpen();
+        if (new_size > Size()) {
+            Reserve(new_size);
+            // Память за последним элементом может хранить данные удалённых ранее элементов
+            std::uninitialized_value_construct_n(Data() + Size(), new_size - Size());
+        }
+        header_->size = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckOpen();
+        // Аргументы могут ссылаться на элементы, а расширение может переместить отображение
+        const T item(std::forward<Args>(args)...);
+        const size_t size = Size();
+        if (size == Capacity()) {
+            Reserve(GrowthPolicy::NextCapacity(Capacity(), size + 1, sizeof(T)));
+        }
+        T* slot = new (Data() + size) T(item);
+        header_->size = size + 1;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(Size() > 0);
+        --header_->size;
+    }
+
+    size_t Size() const noexcept {
+        return header_ != nullptr ? static_cast<size_t>(header_->size) : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return header_ != nullptr ? (mapped_bytes_ - HEADER_SIZE) / sizeof(T) : 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MmapVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return const_cast<MmapVector&>(*this).Data();
+    }
+    const_iterator cend() const noexcept {
+        return cbegin() + Size();
+    }
+
+private:
+    static constexpr uint64_t MAGIC = 0x31304d4d56444156;  // "VADVMM01"
+    static constexpr size_t HEADER_SIZE = 64;
+
+    struct Header {
+        uint64_t magic = MAGIC;
+        uint64_t element_size = sizeof(T);
+        uint64_t element_align = alignof(T);
+        uint64_t size = 0;
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE);
+
+    int fd_ = -1;
+    Header* header_ = nullptr;
+    size_t mapped_bytes_ = 0;
+
+    T* Data() noexcept {
+        return header_ != nullptr
+            ? reinterpret_cast<T*>(reinterpret_cast<std::byte*>(header_) + HEADER_SIZE)
+            : nullptr;
+    }
+
+    // Отображает первые bytes байт файла, при resize_file предварительно меняя размер файла
+    void Map(size_t bytes, bool resize_file) {
+        if (resize_file && ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        void* mapping = header_ == nullptr
+            ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0)
+            : mremap(header_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError(header_ == nullptr ? "mmap" : "mremap");
+        }
+        header_ = static_cast<Header*>(mapping);
+        mapped_bytes_ = bytes;
+    }
+
+    void CheckOpen() const {
+        if (!IsOpen()) {
+            throw std::logic_error("MmapVector: file is not open");
+        }
+    }
+
+    void Validate() const {
+        if (header_->magic != MAGIC) {
+            throw std::runtime_error("MmapVector: not a vector file");
+        }
+        if (header_->element_size != sizeof(T) || header_->element_align != alignof(T)) {
+            throw std::runtime_error("MmapVector: element type mismatch");
+        }
+        if (header_->size > Capacity()) {
+            throw std::runtime_error("MmapVector: file is truncated");
+        }
+    }
+
+    [[noreturn]] static void ThrowSystemError(const char* operation) {
+        throw std::system_error(errno, std::generic_category(), std::string("MmapVector: ") + operation);
+    }
+};
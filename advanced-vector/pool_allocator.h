@@ -0,0 +1,254 @@
+#pragma once
+#include "vector.h"
+
+#include <bit>
+#include <limits>
+
+// Пул освобождённых блоков для векторов, которые часто создаются и разрушаются с похожими
+// размерами (например, в обработчиках запросов). Освобождённый блок не возвращается
+// в operator delete, а остаётся в пуле потока и отдаётся следующему выделению того же
+// класса размера: в установившемся режиме память не запрашивается у malloc,
+// а повторно используемые блоки уже находятся в кэше процессора.
+// Классы размера — степени двойки от POOL_MIN_BLOCK_BYTES до POOL_MAX_BLOCK_BYTES,
+// более крупные блоки выделяются напрямую. Пул у каждого потока свой и работает без
+// блокировок. Блок, освобождённый в другом потоке, попадает в пул этого потока.
+// Пул хранит ограниченное число блоков каждого класса и ограниченный объём памяти (PoolLimits),
+// излишки освобождаются сразу. Блоки пула освобождаются при завершении потока или ReleaseThreadPool
+
+inline constexpr size_t POOL_MIN_BLOCK_BYTES = 64;
+inline constexpr size_t POOL_MAX_BLOCK_BYTES = size_t{1} << 20;
+inline constexpr size_t POOL_MAX_BLOCKS_PER_CLASS = 64;
+
+struct PoolLimits {
+    // Не более max_blocks_per_class блоков каждого класса (не больше POOL_MAX_BLOCKS_PER_CLASS)
+    size_t max_blocks_per_class = 16;
+    // Не более max_retained_bytes байт во всех блоках пула потока
+    size_t max_retained_bytes = size_t{4} << 20;
+};
+
+// Счётчики пула текущего потока
+struct PoolStatistics {
+    // Выделения, обслуженные блоком из пула
+    size_t hits = 0;
+    // Выделения, для которых блок пришлось запросить у operator new
+    size_t misses = 0;
+    // Освобождённые блоки, не поместившиеся в пул
+    size_t overflows = 0;
+    // Блоки и байты, хранящиеся в пуле
+    size_t retained_blocks = 0;
+    size_t retained_bytes = 0;
+};
+
+namespace pool_detail {
+
+// Выравнивание блоков пула: блоки одного класса годятся для любого типа с не более строгим выравниванием
+inline constexpr size_t BLOCK_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+inline constexpr size_t MIN_CLASS_SHIFT = std::countr_zero(POOL_MIN_BLOCK_BYTES);
+inline constexpr size_t CLASS_COUNT = std::countr_zero(POOL_MAX_BLOCK_BYTES) - MIN_CLASS_SHIFT + 1;
+
+// Номер класса размера для блока из bytes байт (bytes <= POOL_MAX_BLOCK_BYTES)
+inline size_t SizeClass(size_t bytes) noexcept {
+    return std::bit_width(std::max(bytes, POOL_MIN_BLOCK_BYTES) - 1) - MIN_CLASS_SHIFT;
+}
+
+inline size_t ClassBytes(size_t size_class) noexcept {
+    return POOL_MIN_BLOCK_BYTES << size_class;
+}
+
+class ThreadPool {
+public:
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        Release();
+        Destroyed() = true;
+    }
+
+    // Пул текущего потока или nullptr, если поток уже завершается и пул разрушен
+    // (например, при разрушении вектора со статическим временем жизни)
+    static ThreadPool* Local() noexcept {
+        if (Destroyed()) {
+            return nullptr;
+        }
+        thread_local ThreadPool pool;
+        return &pool;
+    }
+
+    void* Allocate(size_t size_class) {
+        Class& cache = classes_[size_class];
+        if (cache.count != 0) {
+            ++stats_.hits;
+            --stats_.retained_blocks;
+            stats_.retained_bytes -= ClassBytes(size_class);
+            return cache.blocks[--cache.count];
+        }
+        ++stats_.misses;
+        return ::operator new(ClassBytes(size_class), std::align_val_t{BLOCK_ALIGNMENT});
+    }
+
+    void Deallocate(void* block, size_t size_class) noexcept {
+        Class& cache = classes_[size_class];
+        const size_t bytes = ClassBytes(size_class);
+        if (cache.count < std::min(limits_.max_blocks_per_class, POOL_MAX_BLOCKS_PER_CLASS)
+                && stats_.retained_bytes + bytes <= limits_.max_retained_bytes) {
+            cache.blocks[cache.count++] = block;
+            ++stats_.retained_blocks;
+            stats_.retained_bytes += bytes;
+        } else {
+            ++stats_.overflows;
+            ::operator delete(block, std::align_val_t{BLOCK_ALIGNMENT});
+        }
+    }
+
+    // Освобождает все блоки пула
+    void Release() noexcept {
+        for (size_t i = 0; i < CLASS_COUNT; ++i) {
+            for (; classes_[i].count != 0; --classes_[i].count) {
+                ::operator delete(classes_[i].blocks[classes_[i].count - 1], std::align_val_t{BLOCK_ALIGNMENT});
+            }
+        }
+        stats_.retained_blocks = 0;
+        stats_.retained_bytes = 0;
+    }
+
+    // Блоки, не укладывающиеся в новые ограничения, освобождаются сразу
+    void SetLimits(const PoolLimits& limits) noexcept {
+        limits_ = limits;
+        for (size_t i = CLASS_COUNT; i-- > 0;) {
+            Class& cache = classes_[i];
+            while (cache.count != 0 && (cache.count > limits_.max_blocks_per_class
+                    || stats_.retained_bytes > limits_.max_retained_bytes)) {
+                ::operator delete(cache.blocks[--cache.count], std::align_val_t{BLOCK_ALIGNMENT});
+                --stats_.retained_blocks;
+                stats_.retained_bytes -= ClassBytes(i);
+            }
+        }
+    }
+
+    const PoolLimits& GetLimits() const noexcept {
+        return limits_;
+    }
+
+    const PoolStatistics& GetStatistics() const noexcept {
+        return stats_;
+    }
+
+    void ResetStatistics() noexcept {
+        stats_.hits = 0;
+        stats_.misses = 0;
+        stats_.overflows = 0;
+    }
+
+private:
+    struct Class {
+        void* blocks[POOL_MAX_BLOCKS_PER_CLASS];
+        size_t count = 0;
+    };
+
+    Class classes_[CLASS_COUNT];
+    PoolLimits limits_;
+    PoolStatistics stats_;
+
+    // Флаг тривиально разрушаем и остаётся доступен после разрушения пула
+    static bool& Destroyed() noexcept {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+};
+
+}  // namespace pool_detail
+
+// Ограничения пула текущего потока
+inline void SetThreadPoolLimits(const PoolLimits& limits) noexcept {
+    if (pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local()) {
+        pool->SetLimits(limits);
+    }
+}
+
+inline PoolStatistics GetThreadPoolStatistics() noexcept {
+    pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local();
+    return pool != nullptr ? pool->GetStatistics() : PoolStatistics{};
+}
+
+inline void ResetThreadPoolStatistics() noexcept {
+    if (pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local()) {
+        pool->ResetStatistics();
+    }
+}
+
+// Освобождает блоки, накопленные пулом текущего потока (например, после всплеска нагрузки)
+inline void ReleaseThreadPool() noexcept {
+    if (pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local()) {
+        pool->Release();
+    }
+}
+
+// Аллокатор, берущий блоки из пула текущего потока и возвращающий их туда же. Блок
+// выделяется целым классом размера, и вся его вместимость отдаётся вектору
+// (AllocateAtLeast). Блоки больше POOL_MAX_BLOCK_BYTES и типы со строгим выравниванием
+// обходят пул. Любой экземпляр может освободить память другого, поэтому аллокаторы равны
+template <typename T>
+class PooledAllocator {
+    static constexpr bool POOLABLE = alignof(T) <= pool_detail::BLOCK_ALIGNMENT;
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PooledAllocator() = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return AllocateAtLeast(n).ptr;
+    }
+
+    AllocationResult<T> AllocateAtLeast(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (!POOLABLE || bytes > POOL_MAX_BLOCK_BYTES) {
+            return {static_cast<T*>(::operator new(bytes, std::align_val_t{alignof(T)})), n};
+        }
+        const size_t size_class = pool_detail::SizeClass(bytes);
+        const size_t capacity = pool_detail::ClassBytes(size_class) / sizeof(T);
+        if (pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local()) {
+            return {static_cast<T*>(pool->Allocate(size_class)), capacity};
+        }
+        // Пул потока уже разрушен: блок выделяется так же, как в пуле, чтобы его можно было освободить в любом потоке
+        void* block = ::operator new(pool_detail::ClassBytes(size_class), std::align_val_t{pool_detail::BLOCK_ALIGNMENT});
+        return {static_cast<T*>(block), capacity};
+    }
+
+    // n — вместимость, полученная от AllocateAtLeast: она попадает в тот же класс размера
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!POOLABLE || bytes > POOL_MAX_BLOCK_BYTES) {
+            ::operator delete(buf, std::align_val_t{alignof(T)});
+        } else if (pool_detail::ThreadPool* pool = pool_detail::ThreadPool::Local()) {
+            pool->Deallocate(buf, pool_detail::SizeClass(bytes));
+        } else {
+            ::operator delete(buf, std::align_val_t{pool_detail::BLOCK_ALIGNMENT});
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const PooledAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+// Вектор, переиспользующий буферы через пул потока
+template <typename T, typename GrowthPolicy = DoublingGrowth, typename Stats = NoStats>
+using PooledVector = Vector<T, PooledAllocator<T>, GrowthPolicy, Stats>;
@@ -0,0 +1,291 @@
+#pragma once
+#include "vector.h"
+
+#include <bit>
+#include <compare>
+
+// Вектор из блоков RawMemory по BlockSize элементов. При росте добавляется новый блок,
+// а уже добавленные элементы не перемещаются: ссылки на них остаются действительными,
+// рост не вызывает пауз на перенос всех элементов и не требует памяти под две копии.
+// Размер блока — степень двойки, поэтому доступ по индексу сводится к сдвигу и маске
+template <typename T, size_t BlockSize = std::bit_floor(std::max<size_t>((size_t{1} << 16) / sizeof(T), 1))>
+class SegmentedVector {
+    static_assert(std::has_single_bit(BlockSize), "BlockSize must be a power of two");
+
+    static constexpr size_t BLOCK_SHIFT = static_cast<size_t>(std::countr_zero(BlockSize));
+    static constexpr size_t BLOCK_MASK = BlockSize - 1;
+
+public:
+    template <bool IsConst>
+    class BasicIterator;
+
+    using value_type = T;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    static constexpr size_t BLOCK_SIZE = BlockSize;
+
+    SegmentedVector() = default;
+
+    // Делегирование конструктору по умолчанию гарантирует вызов деструктора, если копирование
+    // элемента бросит исключение: уже скопированные элементы будут разрушены
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector()  //
+    {
+        Reserve(other.size_);
+        for (const T& item : other) {
+            EmplaceBack(item);
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : blocks_(std::move(other.blocks_))
+        , size_(std::exchange(other.size_, 0))  //
+    {
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        blocks_.Swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    // Выделяет блоки, чтобы вместить capacity элементов
+    void Reserve(size_t capacity) {
+        const size_t block_count = (capacity + BLOCK_MASK) >> BLOCK_SHIFT;
+        if (block_count > blocks_.Size()) {
+            blocks_.Reserve(block_count);
+            while (blocks_.Size() < block_count) {
+                blocks_.EmplaceBack(BlockSize);
+            }
+        }
+    }
+
+    // Освобождает блоки, в которых не осталось элементов
+    void ShrinkToFit() {
+        while (blocks_.Size() > ((size_ + BLOCK_MASK) >> BLOCK_SHIFT)) {
+            blocks_.PopBack();
+        }
+        blocks_.ShrinkToFit();
+    }
+
+    void Clear() noexcept {
+        for (size_t i = 0; size_ > 0; ++i) {
+            const size_t count = std::min(size_, BlockSize);
+            std::destroy_n(blocks_[i].GetAddress(), count);
+            size_ -= count;
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Элементы не перемещаются, поэтому аргументы, ссылающиеся на них, остаются действительными
+            blocks_.EmplaceBack(BlockSize);
+        }
+        T* item = new (blocks_[size_ >> BLOCK_SHIFT] + (size_ & BLOCK_MASK)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *item;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return blocks_.Size() << BLOCK_SHIFT;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return blocks_[index >> BLOCK_SHIFT][index & BLOCK_MASK];
+    }
+
+    // Копирует элементы в непрерывный вектор
+    Vector<T> Flatten() const& {
+        Vector<T> result;
+        result.Reserve(size_);
+        ForEachBlock([&result](const T* first, size_t count) {
+            result.AppendRange(std::span<const T>(first, count));
+        });
+        return result;
+    }
+
+    // Перемещает элементы в непрерывный вектор, оставляя исходный пустым
+    Vector<T> Flatten() && {
+        Vector<T> result;
+        result.Reserve(size_);
+        ForEachBlock([&result](T* first, size_t count) {
+            result.Insert(result.end(), std::make_move_iterator(first), std::make_move_iterator(first + count));
+        });
+        Clear();
+        return result;
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator cend() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Container = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+
+        BasicIterator() = default;
+
+        // Неконстантный итератор неявно приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+            : container_(other.container_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*container_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        friend class SegmentedVector;
+        friend class BasicIterator<!IsConst>;
+
+        BasicIterator(Container* container, size_t index) noexcept
+            : container_(container)
+            , index_(index) {
+        }
+
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+private:
+    Vector<RawMemory<T>> blocks_;
+    size_t size_ = 0;
+
+    // Вызывает f(first, count) для элементов каждого блока по порядку
+    template <typename F>
+    void ForEachBlock(F&& f) {
+        for (size_t i = 0, rest = size_; rest > 0; ++i) {
+            const size_t count = std::min(rest, BlockSize);
+            f(blocks_[i].GetAddress(), count);
+            rest -= count;
+        }
+    }
+
+    template <typename F>
+    void ForEachBlock(F&& f) const {
+        const_cast<SegmentedVector&>(*this).ForEachBlock([&f](T* first, size_t count) {
+            f(static_cast<const T*>(first), count);
+        });
+    }
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Неизменяемый вектор, буфер которого разделяют все копии. Копирование увеличивает
+// счётчик ссылок и не копирует элементы, поэтому одну таблицу могут читать многие потоки
+// без роста потребления памяти. Изменение (Mutate) копирует элементы, только если
+// буфер разделён с другими копиями:
+//     SharedVector<Route> routes = std::move(loaded_routes).Freeze();
+//     SharedVector<Route> reader_copy = routes;  // элементы не копируются
+//     routes.Mutate().PushBack(extra_route);      // копируются: буфер разделён
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+class SharedVector {
+public:
+    using VectorType = Vector<T, Allocator, GrowthPolicy, Stats>;
+    using value_type = T;
+    using const_iterator = const T*;
+
+    SharedVector() = default;
+
+    // Забирает буфер вектора items без копирования элементов
+    explicit SharedVector(VectorType&& items)
+        : data_(std::make_shared<VectorType>(std::move(items))) {
+    }
+
+    size_t Size() const noexcept {
+        return data_ != nullptr ? data_->Size() : 0;
+    }
+
+    // Число копий, разделяющих буфер
+    long UseCount() const noexcept {
+        return data_.use_count();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return (*data_)[index];
+    }
+
+    const T* GetAddress() const noexcept {
+        return data_ != nullptr ? data_->GetAddress() : nullptr;
+    }
+
+    const_iterator begin() const noexcept {
+        return GetAddress();
+    }
+    const_iterator end() const noexcept {
+        return GetAddress() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Возвращает вектор для изменения, предварительно скопировав элементы, если буфер
+    // разделён с другими копиями. Ссылка действительна до копирования или изменения этой копии
+    VectorType& Mutate() {
+        if (data_ == nullptr) {
+            data_ = std::make_shared<VectorType>();
+        } else if (data_.use_count() > 1) {
+            data_ = std::make_shared<VectorType>(*data_);
+        } else {
+            AcquireSoleOwnership();
+        }
+        return *data_;
+    }
+
+    // Возвращает элементы в виде обычного вектора: перемещает их, если буфер больше
+    // никем не разделён, иначе копирует. Эта копия становится пустой
+    VectorType Thaw() && {
+        std::shared_ptr<VectorType> data = std::move(data_);
+        if (data == nullptr) {
+            return VectorType();
+        }
+        if (data.use_count() > 1) {
+            return VectorType(*data);
+        }
+        AcquireSoleOwnership();
+        return std::move(*data);
+    }
+
+private:
+    // use_count читается без синхронизации. Другие копии уменьшают счётчик с семантикой
+    // release, поэтому барьер acquire после того, как копия осталась единственной, делает
+    // видимыми все их обращения к элементам до начала изменения. ThreadSanitizer барьеры
+    // не отслеживает, и GCC предупреждает об этом при -fsanitize=thread
+    static void AcquireSoleOwnership() noexcept {
+#if defined(__GNUC__) && !defined(__clang__) && defined(__SANITIZE_THREAD__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wtsan"
+#endif
+        std::atomic_thread_fence(std::memory_order_acquire);
+#if defined(__GNUC__) && !defined(__clang__) && defined(__SANITIZE_THREAD__)
+#pragma GCC diagnostic pop
+#endif
+    }
+
+    template <typename Shared>
+    friend class AtomicSharedVector;
+
+    std::shared_ptr<VectorType> data_;
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+SharedVector<T, Allocator, GrowthPolicy, Stats> Vector<T, Allocator, GrowthPolicy, Stats>::Freeze() && {
+    return SharedVector<T, Allocator, GrowthPolicy, Stats>(std::move(*this));
+}
+
+// Ячейка с текущей версией разделяемого вектора для перезагрузки таблиц: писатель
+// публикует новую версию заменой указателя, а читатели получают свою копию через Load.
+// Блокировка защищает только копирование и обмен указателя, а старая версия
+// освобождается вне её, когда её отпустит последний читатель.
+// std::atomic<std::shared_ptr> здесь не используется: в libstdc++ он не свободен
+// от блокировок (is_lock_free() == false) и сам захватывает внутреннюю спин-блокировку,
+// которую ThreadSanitizer не видит и сообщает о ложных гонках. Мьютекс даёт ту же
+// короткую критическую секцию, но без активного ожидания и проверяется санитайзером
+template <typename Shared>
+class AtomicSharedVector {
+public:
+    AtomicSharedVector() = default;
+
+    explicit AtomicSharedVector(Shared value) noexcept
+        : data_(std::move(value.data_)) {
+    }
+
+    AtomicSharedVector(const AtomicSharedVector&) = delete;
+    AtomicSharedVector& operator=(const AtomicSharedVector&) = delete;
+
+    Shared Load() const {
+        Shared result;
+        std::lock_guard guard(mutex_);
+        result.data_ = data_;
+        return result;
+    }
+
+    void Store(Shared value) {
+        Exchange(std::move(value));
+    }
+
+    Shared Exchange(Shared value) {
+        {
+            std::lock_guard guard(mutex_);
+            data_.swap(value.data_);
+        }
+        return value;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<typename Shared::VectorType> data_;
+};
@@ -0,0 +1,275 @@
+#pragma once
+#include "vector.h"
+
+// Вектор, хранящий до N элементов во встроенном буфере. Память из аллокатора
+// выделяется, только когда элементы перестают помещаться во встроенный буфер
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "Inline capacity must be positive");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr bool CAN_REALLOCATE =
+        IsTriviallyRelocatableV<T> && RawMemory<T, Allocator>::SUPPORTS_REALLOCATE;
+
+public:
+    using allocator_type = Allocator;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Allocator& alloc = Allocator())
+        : heap_(alloc) {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    SmallVector(const SmallVector& other, const Allocator& alloc)
+        : heap_(alloc) {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.heap_.GetAllocator()) {
+        if (other.IsInline()) {
+            // Встроенный буфер забрать нельзя, элементы переносятся по одному
+            vector_detail::MoveItemsInNewMemory(other.Data(), Data(), other.size_);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+            UpdateData();
+            other.UpdateData();
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            AssignElements(rhs.Data(), rhs.size_);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(
+            std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+            && AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if (rhs.IsInline() || (!AllocTraits::is_always_equal::value && GetAllocator() != rhs.GetAllocator())) {
+                AssignElements(std::make_move_iterator(rhs.Data()), rhs.size_);
+            } else {
+                std::destroy_n(Data(), size_);
+                size_ = 0;
+                heap_.Swap(rhs.heap_);
+                std::swap(size_, rhs.size_);
+                UpdateData();
+                rhs.UpdateData();
+            }
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    void Swap(SmallVector& other) noexcept(
+            std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+            && AllocTraits::is_always_equal::value) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+            UpdateData();
+            other.UpdateData();
+        } else {
+            SmallVector temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    // Элементы хранятся во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if constexpr (CAN_REALLOCATE) {
+            if (!IsInline()) {
+                heap_.Reallocate(new_capacity);
+                UpdateData();
+                return;
+            }
+        }
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        vector_detail::MoveItemsInNewMemory(Data(), new_data.GetAddress(), size_);
+        heap_.Swap(new_data);
+        UpdateData();
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        }
+        if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(new_size);
+            }
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        --size_;
+        std::destroy_at(Data() + size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        Emplace(begin() + size_, std::forward<Args>(args)...);
+        return Data()[size_ - 1];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        size_t index = pos - begin();
+        if (size_ == Capacity()) {
+            InsertWithReallocate(index, std::forward<Args>(args)...);
+        } else {
+            vector_detail::InsertInPlace(Data(), size_, index, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        size_t index = pos - begin();
+        vector_detail::Erase(Data(), size_, index);
+        --size_;
+        return begin() + index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+private:
+    RawMemory<T, Allocator> heap_;
+    size_t size_ = 0;
+    // Начало элементов: встроенный буфер или heap_. Указатель хранится, а не выбирается
+    // при каждом обращении, и после роста компилятор не видит ветки со встроенным буфером
+    // (иначе GCC при -O2 -Warray-bounds предупреждал бы об индексах за его границей)
+    T* data_ = reinterpret_cast<T*>(inline_);
+    alignas(T) std::byte inline_[N * sizeof(T)];
+
+    T* Data() noexcept {
+        return data_;
+    }
+
+    // Вызывается после каждого изменения heap_
+    void UpdateData() noexcept {
+        data_ = IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    // Присваивает вектору count элементов, начиная с first, переиспользуя
+    // уже сконструированные элементы и имеющуюся память
+    template <typename InputIt>
+    void AssignElements(InputIt first, size_t count) {
+        if (count > Capacity()) {
+            RawMemory<T, Allocator> new_data(count, heap_.GetAllocator());
+            std::uninitialized_copy_n(first, count, new_data.GetAddress());
+            std::destroy_n(Data(), size_);
+            heap_.Swap(new_data);
+            UpdateData();
+        } else {
+            const size_t common = std::min(count, size_);
+            std::copy_n(first, common, Data());
+            std::uninitialized_copy_n(std::next(first, common), count - common, Data() + common);
+            if (count < size_) {
+                std::destroy_n(Data() + count, size_ - count);
+            }
+        }
+        size_ = count;
+    }
+
+    template <typename... Args>
+    void InsertWithReallocate(size_t index, Args&&... args) {
+        const size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T));
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        vector_detail::InsertInNewMemory(Data(), size_, new_data.GetAddress(), index,
+            std::forward<Args>(args)...);
+        heap_.Swap(new_data);
+        UpdateData();
+    }
+};
@@ -0,0 +1,422 @@
+#pragma once
+#include "vector.h"
+
+#include <compare>
+#include <tuple>
+
+// Вектор строк из полей типов Ts..., хранящий каждое поле в отдельном буфере
+// (структура массивов). Циклы, которым нужны только некоторые поля, читают лишь их
+// столбцы и не тратят кеш на остальные поля строки:
+//     SoaVector<Vec3, Vec3, float> particles;  // позиция, скорость, масса
+//     for (Vec3& position : particles.Column<0>()) { ... }
+// Операции дают те же гарантии безопасности исключений, что и Vector: вставка
+// в конец и реаллокация — строгую, удаление — базовую
+template <typename... Ts>
+class SoaVector {
+    static_assert(sizeof...(Ts) > 0, "SoaVector needs at least one column");
+    // Перенос столбца без копирования и без отката, бросивший исключение, испортил бы
+    // исходные строки после того, как другие столбцы уже перенесены
+    static_assert(((IsTriviallyRelocatableV<Ts> || std::is_nothrow_move_constructible_v<Ts>
+        || std::is_copy_constructible_v<Ts> || IsRollbackRelocatableV<Ts>) && ...),
+        "SoaVector columns must be nothrow movable, copyable or rollback relocatable");
+
+    using Columns = std::tuple<RawMemory<Ts>...>;
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    // Перенос столбца в новую память может бросить исключение: столбец копируется
+    // или перемещается с откатом
+    template <size_t I>
+    static constexpr bool THROWS_ON_RELOCATE = !IsTriviallyRelocatableV<ColumnType<I>>
+        && !std::is_nothrow_move_constructible_v<ColumnType<I>>
+        && (std::is_copy_constructible_v<ColumnType<I>> || IsRollbackRelocatableV<ColumnType<I>>);
+
+    // Сдвиг элементов столбца при удалении может бросить исключение
+    template <size_t I>
+    static constexpr bool THROWS_ON_SHIFT = !IsTriviallyRelocatableV<ColumnType<I>>
+        && !std::is_nothrow_move_assignable_v<ColumnType<I>>;
+
+public:
+    template <bool IsConst>
+    class BasicIterator;
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SoaVector() = default;
+
+    SoaVector(const SoaVector& other)
+        : columns_(Allocate(other.size_))
+        , size_(other.size_)  //
+    {
+        size_t copied = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                std::uninitialized_copy_n(other.template Data<column>(), size_, Data<column>());
+                ++copied;
+            });
+        } catch (...) {
+            DestroyColumns(columns_, size_, copied);
+            throw;
+        }
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))  //
+    {
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        DestroyColumns(columns_, size_, sizeof...(Ts));
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        ForEachColumn([&](auto column) {
+            std::get<column>(columns_).Swap(std::get<column>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Columns new_columns = Allocate(new_capacity);
+        RelocateColumns(new_columns);
+        columns_.swap(new_columns);
+    }
+
+    // Добавляет строку, конструируя каждое поле из соответствующего аргумента
+    template <typename... Args>
+    void EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "EmplaceBack takes one argument per column");
+        if (size_ == Capacity()) {
+            Columns new_columns = Allocate(DoublingGrowth::NextCapacity(Capacity(), size_ + 1, 0));
+            // Аргументы могут ссылаться на поля строк, поэтому новая строка конструируется
+            // до переноса старых
+            ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+            try {
+                RelocateColumns(new_columns);
+            } catch (...) {
+                DestroyRow(new_columns, size_, sizeof...(Ts));
+                throw;
+            }
+            columns_.swap(new_columns);
+        } else {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        DestroyRow(columns_, size_, sizeof...(Ts));
+    }
+
+    void Clear() noexcept {
+        DestroyColumns(columns_, size_, sizeof...(Ts));
+        size_ = 0;
+    }
+
+    // Удаляет строку index. Если исключение бросит перемещающее присваивание поля,
+    // все строки останутся сконструированными, но сдвинутыми лишь в части столбцов
+    void Erase(size_t index) {
+        assert(index < size_);
+        // Сначала сдвигаются столбцы, сдвиг которых может бросить исключение: пока они
+        // не сдвинуты, остальные столбцы не тронуты и размер вектора верен
+        ForEachColumn([&](auto column) {
+            if constexpr (THROWS_ON_SHIFT<column>) {
+                std::move(Data<column>() + index + 1, Data<column>() + size_, Data<column>() + index);
+            }
+        });
+        ForEachColumn([&](auto column) {
+            if constexpr (THROWS_ON_SHIFT<column>) {
+                std::destroy_at(Data<column>() + size_ - 1);
+            } else {
+                vector_detail::Erase(Data<column>(), size_, index);
+            }
+        });
+        --size_;
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos.Index();
+        Erase(index);
+        return begin() + static_cast<std::ptrdiff_t>(index);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Столбец поля I
+    template <size_t I>
+    std::span<ColumnType<I>> Column() noexcept {
+        return {Data<I>(), size_};
+    }
+
+    template <size_t I>
+    std::span<const ColumnType<I>> Column() const noexcept {
+        return {Data<I>(), size_};
+    }
+
+    // Поле I строки index
+    template <size_t I>
+    ColumnType<I>& Get(size_t index) noexcept {
+        assert(index < size_);
+        return Data<I>()[index];
+    }
+
+    template <size_t I>
+    const ColumnType<I>& Get(size_t index) const noexcept {
+        assert(index < size_);
+        return Data<I>()[index];
+    }
+
+    // Ссылки на все поля строки index
+    std::tuple<Ts&...> operator[](size_t index) noexcept {
+        return *(begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    std::tuple<const Ts&...> operator[](size_t index) const noexcept {
+        return *(begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    iterator begin() noexcept {
+        return iterator(ColumnPointers(std::index_sequence_for<Ts...>{}), 0);
+    }
+    iterator end() noexcept {
+        return begin() + static_cast<std::ptrdiff_t>(size_);
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return const_cast<SoaVector&>(*this).begin();
+    }
+    const_iterator cend() const noexcept {
+        return const_cast<SoaVector&>(*this).end();
+    }
+
+    // Итератор по строкам. Разыменование возвращает кортеж ссылок на поля строки,
+    // поэтому строки удобно разбирать структурными привязками:
+    //     for (auto [position, velocity, mass] : particles) { ... }
+    template <bool IsConst>
+    class BasicIterator {
+        template <typename T>
+        using Pointer = std::conditional_t<IsConst, const T*, T*>;
+
+        template <typename T>
+        using Reference = std::conditional_t<IsConst, const T&, T&>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::tuple<Ts...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::tuple<Reference<Ts>...>;
+        using pointer = void;
+
+        BasicIterator() = default;
+
+        // Неконстантный итератор неявно приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+            : columns_(other.columns_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return std::apply([this](auto... columns) {
+                return reference(columns[index_]...);
+            }, columns_);
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ - rhs.index_;
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+        size_t Index() const noexcept {
+            return static_cast<size_t>(index_);
+        }
+
+    private:
+        friend class SoaVector;
+        friend class BasicIterator<!IsConst>;
+
+        BasicIterator(std::tuple<Pointer<Ts>...> columns, difference_type index) noexcept
+            : columns_(columns)
+            , index_(index) {
+        }
+
+        std::tuple<Pointer<Ts>...> columns_;
+        difference_type index_ = 0;
+    };
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+
+    template <typename F>
+    static void ForEachColumn(F&& f) {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (f(std::integral_constant<size_t, Is>{}), ...);
+        }(std::index_sequence_for<Ts...>{});
+    }
+
+    template <size_t I>
+    ColumnType<I>* Data() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    const ColumnType<I>* Data() const noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t... Is>
+    std::tuple<Ts*...> ColumnPointers(std::index_sequence<Is...>) noexcept {
+        return {Data<Is>()...};
+    }
+
+    static Columns Allocate(size_t capacity) {
+        return Columns(RawMemory<Ts>(capacity)...);
+    }
+
+    // Конструирует поля строки index в столбцах columns. Если конструктор поля бросит
+    // исключение, уже сконструированные поля строки разрушаются
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            [&]<size_t... Is>(std::index_sequence<Is...>) {
+                ((std::construct_at(std::get<Is>(columns) + index, std::forward<Args>(args)), ++constructed), ...);
+            }(std::index_sequence_for<Ts...>{});
+        } catch (...) {
+            DestroyRow(columns, index, constructed);
+            throw;
+        }
+    }
+
+    // Разрушает поля строки index в первых count столбцах
+    static void DestroyRow(Columns& columns, size_t index, size_t count) noexcept {
+        ForEachColumn([&](auto column) {
+            if (column < count) {
+                std::destroy_at(std::get<column>(columns) + index);
+            }
+        });
+    }
+
+    // Разрушает size элементов в первых count столбцах
+    static void DestroyColumns(Columns& columns, size_t size, size_t count) noexcept {
+        ForEachColumn([&](auto column) {
+            if (column < count) {
+                std::destroy_n(std::get<column>(columns).GetAddress(), size);
+            }
+        });
+    }
+
+    // Переносит элементы всех столбцов в неинициализированные буферы new_columns.
+    // Столбцы, перенос которых может бросить исключение, переносятся первыми без
+    // разрушения исходных элементов: пока они не перенесены целиком, исходные строки
+    // целы, и при исключении достаточно отменить перенос готовых столбцов
+    void RelocateColumns(Columns& new_columns) {
+        size_t relocated = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                if constexpr (THROWS_ON_RELOCATE<column>) {
+                    vector_detail::ConstructRelocated(Data<column>(), size_, std::get<column>(new_columns).GetAddress());
+                }
+                ++relocated;
+            });
+        } catch (...) {
+            ForEachColumn([&](auto column) {
+                if constexpr (THROWS_ON_RELOCATE<column>) {
+                    if (column < relocated) {
+                        vector_detail::UndoConstructRelocated(Data<column>(), size_,
+                            std::get<column>(new_columns).GetAddress());
+                    }
+                }
+            });
+            throw;
+        }
+        ForEachColumn([&](auto column) {
+            if constexpr (THROWS_ON_RELOCATE<column>) {
+                std::destroy_n(Data<column>(), size_);
+            } else {
+                vector_detail::MoveItemsInNewMemory(Data<column>(), std::get<column>(new_columns).GetAddress(), size_);
+            }
+        });
+    }
+};
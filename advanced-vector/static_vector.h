@@ -0,0 +1,303 @@
+#pragma once
+#include "vector.h"
+
+// Вектор вместимостью N элементов во встроенном буфере, который никогда не выделяет память.
+// Подходит для потоков реального времени, где недопустимо скрытое выделение при росте.
+// Добавление в заполненный вектор бросает std::length_error, а TryEmplaceBack
+// и TryPushBack вместо этого сообщают о неудаче возвращаемым значением
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "Capacity must be positive");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    explicit StaticVector(size_t size) {
+        CheckCapacity(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    StaticVector(std::initializer_list<T> items) {
+        CheckCapacity(items.size());
+        std::uninitialized_copy_n(items.begin(), items.size(), Data());
+        size_ = items.size();
+    }
+
+    StaticVector(const StaticVector& other) {
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    // Встроенный буфер забрать нельзя, элементы переносятся по одному, а other становится пустым
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        vector_detail::MoveItemsInNewMemory(other.Data(), Data(), other.size_);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            AssignElements(rhs.Data(), rhs.size_);
+        }
+        return *this;
+    }
+
+    // Как и перемещающий конструктор, оставляет rhs пустым
+    StaticVector& operator=(StaticVector&& rhs) noexcept(
+            std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            AssignElements(std::make_move_iterator(rhs.Data()), rhs.size_);
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    ~StaticVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    void Swap(StaticVector& other) noexcept(
+            std::is_nothrow_move_constructible_v<T> && std::is_nothrow_swappable_v<T>) {
+        if (this == &other) {
+            return;
+        }
+        StaticVector& shorter = size_ < other.size_ ? *this : other;
+        StaticVector& longer = size_ < other.size_ ? other : *this;
+        std::swap_ranges(shorter.Data(), shorter.Data() + shorter.size_, longer.Data());
+        // Хвост длинного вектора переносится в короткий
+        const size_t rest = longer.size_ - shorter.size_;
+        vector_detail::MoveItemsInNewMemory(longer.Data() + shorter.size_, shorter.Data() + shorter.size_, rest);
+        shorter.size_ += rest;
+        longer.size_ -= rest;
+    }
+
+    // Память не выделяется: проверяет только, что capacity элементов поместится
+    void Reserve(size_t capacity) const {
+        CheckCapacity(capacity);
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        } else {
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(Data() + size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        return *TryEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Добавляет элемент, если есть место, и возвращает указатель на него. В заполненном
+    // векторе возвращает nullptr, не конструируя элемент. Исключение может бросить
+    // только конструктор T
+    template <typename... Args>
+    T* TryEmplaceBack(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>) {
+        if (size_ == N) {
+            return nullptr;
+        }
+        T* item = new (Data() + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        return item;
+    }
+
+    bool TryPushBack(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        return TryEmplaceBack(value) != nullptr;
+    }
+    bool TryPushBack(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        return TryEmplaceBack(std::move(value)) != nullptr;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StaticVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    // Доступ с проверкой индекса в любом режиме сборки
+    const T& At(size_t index) const {
+        return const_cast<StaticVector&>(*this).At(index);
+    }
+
+    T& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("StaticVector::At: index is out of range");
+        }
+        return Data()[index];
+    }
+
+    const T* GetAddress() const noexcept {
+        return Data();
+    }
+
+    T* GetAddress() noexcept {
+        return Data();
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+    const_iterator end() const noexcept {
+        return cend();
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        const size_t index = pos - cbegin();
+        CheckCapacity(size_ + 1);
+        vector_detail::InsertInPlace(Data(), size_, index, std::forward<Args>(args)...);
+        ++size_;
+        return begin() + index;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставляет элементы [first, last), которые не должны принадлежать вектору. Для
+    // однонаправленных итераторов вместимость проверяется до вставки, и при нехватке места
+    // вектор не меняется. Для прочих итераторов уже вставленные элементы остаются в конце
+    template <std::input_iterator InputIt>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t index = pos - cbegin();
+        if constexpr (std::forward_iterator<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            CheckCapacity(size_ + count);
+            vector_detail::InsertRangeInPlace(Data(), size_, index, first, count);
+            size_ += count;
+        } else {
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+        }
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        const size_t index = pos - cbegin();
+        vector_detail::Erase(Data(), size_, index);
+        --size_;
+        return begin() + index;
+    }
+
+    // Удаляет элементы [first, last) одним сдвигом хвоста
+    iterator Erase(const_iterator first, const_iterator last) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+        if (count != 0) {
+            vector_detail::EraseRange(Data(), size_, index, count);
+            size_ -= count;
+        }
+        return begin() + index;
+    }
+
+    // Удаляет элемент за O(1), перенося на его место последний элемент
+    iterator EraseUnordered(const_iterator pos) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        const size_t index = pos - cbegin();
+        vector_detail::EraseUnordered(Data(), size_, index);
+        --size_;
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, удовлетворяющие pred, за один проход и возвращает их количество
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        const iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t count = end() - new_end;
+        std::destroy_n(new_end, count);
+        size_ -= count;
+        return count;
+    }
+
+private:
+    size_t size_ = 0;
+    alignas(T) std::byte storage_[N * sizeof(T)];
+
+    T* Data() noexcept {
+        return reinterpret_cast<T*>(storage_);
+    }
+
+    const T* Data() const noexcept {
+        return reinterpret_cast<const T*>(storage_);
+    }
+
+    static void CheckCapacity(size_t size) {
+        if (size > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    // Присваивает вектору count элементов, начиная с first, переиспользуя
+    // уже сконструированные элементы
+    template <typename InputIt>
+    void AssignElements(InputIt first, size_t count) {
+        const size_t common = std::min(count, size_);
+        std::copy_n(first, common, Data());
+        std::uninitialized_copy_n(std::next(first, common), count - common, Data() + common);
+        if (count < size_) {
+            std::destroy_n(Data() + count, size_ - count);
+        }
+        size_ = count;
+    }
+};
@@ -1,291 +1,1842 @@
 #pragma once
 #include <cassert>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
 #include <new>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <array>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <ranges>
+#include <source_location>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <thread>
+#include <type_traits>
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Отладочный режим итераторов включается макросом VECTOR_DEBUG_ITERATORS, который
+// должен быть одинаково определён во всех единицах трансляции программы. В этом режиме
+// итераторы Vector помнят поколение вектора и проверяют при каждом обращении, что вектор
+// жив, итератор не стал недействительным и не вышел за границы, а operator[] проверяет
+// индекс независимо от NDEBUG. При нарушении программа печатает сообщение и аварийно
+// завершается. Без макроса итераторы остаются обычными указателями
+
+// Vector можно использовать в константных выражениях (например, для построения таблиц
+// во время компиляции) с политикой статистики NoStats и аллокатором, подобным std::allocator.
+// Память, выделенная во время компиляции, должна быть освобождена там же, поэтому
+// результат переносится в std::array функцией ToArray. Отладочный режим итераторов
+// в константных выражениях не поддерживается
+
+// Тип тривиально перемещаем, если перемещение объекта с последующим разрушением
+// исходного равносильно побайтовому копированию его памяти. Такие элементы вектор
+// переносит при помощи memcpy/memmove. Свои типы (например, дескрипторы ресурсов)
+// можно пометить, специализировав шаблон
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+// Тип переносим с откатом, если его конструктор перемещения может бросить исключение,
+// но перемещающее присваивание в объект, из которого переместили, не бросает. Такие
+// элементы вектор переносит в новую память перемещением, а если перемещение бросит
+// исключение, возвращает уже перенесённые элементы обратно, сохраняя строгую гарантию
+// без копирования. Прочие элементы с бросающим перемещением копируются. Свои типы
+// (например, контейнеры, выделяющие память в конструкторе перемещения) можно пометить,
+// специализировав шаблон
+template <typename T>
+struct IsRollbackRelocatable : std::false_type {};
+
+template <typename T>
+inline constexpr bool IsRollbackRelocatableV = IsRollbackRelocatable<T>::value;
+
+// Результат выделения памяти аллокатором, который может выделить больше запрошенного
+template <typename T>
+struct AllocationResult {
+    T* ptr = nullptr;
+    size_t count = 0;
+};
+
+// Аллокатор поверх malloc/free. Помимо стандартного интерфейса умеет сообщать реальный
+// размер выделенного блока (AllocateAtLeast) и изменять размер блока через realloc
+// (Reallocate). RawMemory использует обе возможности, если аллокатор их предоставляет
 template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not support over-aligned types");
+
+public:
+    using value_type = T;
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return AllocateAtLeast(n).ptr;
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        std::free(buf);
+    }
+
+    AllocationResult<T> AllocateAtLeast(size_t n) {
+        CheckCount(n);
+        return MakeResult(std::malloc(n * sizeof(T)), n);
+    }
+
+    // Изменяет размер блока buf. Блок может переехать, а содержимое переносится побайтово,
+    // поэтому вызывать можно только для тривиально перемещаемых элементов
+    AllocationResult<T> Reallocate(T* buf, size_t /*old_n*/, size_t new_n) {
+        CheckCount(new_n);
+        return MakeResult(std::realloc(buf, new_n * sizeof(T)), new_n);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    // Размер блока в байтах должен помещаться в size_t, иначе malloc получит усечённый размер
+    static void CheckCount(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+    }
+
+    static AllocationResult<T> MakeResult(void* buf, size_t n) {
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+#if defined(__GLIBC__)
+        // Размерный класс malloc часто больше запрошенного, излишек можно занять элементами.
+        // Вместимость берётся только из реального размера блока
+        n = malloc_usable_size(buf) / sizeof(T);
+#endif
+        return {static_cast<T*>(buf), n};
+    }
+};
+
+// Аллокатор, выравнивающий буфер по границе Alignment байт (по умолчанию alignof(T))
+// при помощи выровненных operator new/delete. Размер блока округляется до целого числа
+// отрезков по Alignment байт, и излишек отдаётся вектору как вместимость
+// (AllocateAtLeast). При Alignment, равном ширине SIMD-регистра (32 для AVX2, 64 для
+// AVX-512), векторные циклы могут читать весь буфер выровненными загрузками без
+// скалярной обработки начала и конца:
+//     Vector<float, AlignedAllocator<float, 64>> values;
+template <typename T, size_t Alignment = alignof(T)>
+class AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, std::max(Alignment, alignof(U))>;
+    };
+
+    static constexpr size_t ALIGNMENT = Alignment;
+
+    AlignedAllocator() = default;
+
+    template <typename U, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlignment>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return AllocateAtLeast(n).ptr;
+    }
+
+    AllocationResult<T> AllocateAtLeast(size_t n) {
+        // Размер блока в байтах вместе с округлением должен помещаться в size_t
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = RoundToAlignment(n * sizeof(T));
+        if (bytes < n * sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* buf = ::operator new(bytes, std::align_val_t{Alignment});
+        return {static_cast<T*>(buf), bytes / sizeof(T)};
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        ::operator delete(buf, std::align_val_t{Alignment});
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator==(const AlignedAllocator<U, OtherAlignment>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator!=(const AlignedAllocator<U, OtherAlignment>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t RoundToAlignment(size_t bytes) noexcept {
+        return (bytes + Alignment - 1) / Alignment * Alignment;
+    }
+};
+
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator,
+    std::void_t<decltype(std::declval<Allocator&>().AllocateAtLeast(size_t{}))>> : std::true_type {};
+
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().Reallocate(
+    std::declval<typename Allocator::value_type*>(), size_t{}, size_t{}))>> : std::true_type {};
+
+// Политики роста определяют вместимость, до которой вектор расширяется, когда в нём
+// не хватает места. NextCapacity получает текущую вместимость, минимально необходимую
+// вместимость и размер элемента в байтах. Собственная политика должна предоставлять
+// такую же статическую функцию
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity * 2);
+    }
+};
+
+struct OneAndHalfGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity + capacity / 2);
+    }
+};
+
+// Округляет вместимость, выбранную политикой Base, вверх до целого числа страниц памяти
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t bytes = Base::NextCapacity(capacity, required, element_size) * element_size;
+        return (bytes + PageSize - 1) / PageSize * PageSize / element_size;
+    }
+};
+
+// Политика статистики определяет обработчики событий памяти вектора. NoStats
+// используется по умолчанию: её обработчики пусты и полностью устраняются компилятором.
+// Собирающая статистику политика CountingStats объявлена в vector_stats.h
+struct NoStats {
+    // Выделен блок под capacity элементов размером bytes байт
+    static constexpr void OnAllocate(size_t /*capacity*/, size_t /*bytes*/) noexcept {
+    }
+    // Освобождён блок размером bytes байт
+    static constexpr void OnDeallocate(size_t /*bytes*/) noexcept {
+    }
+    // Вектор меняет буфер с элементами: вместимость old_capacity меняется на new_capacity
+    static constexpr void OnReallocate(size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+    }
+    // Элементы перенесены в новую память перемещением (moved) или копированием (copied)
+    static constexpr void OnRelocate(size_t /*moved*/, size_t /*copied*/) noexcept {
+    }
+    // Вставка элемента в заполненный вектор из size элементов, вызванная в site,
+    // перевыделила буфер вместимостью new_capacity
+    static constexpr void OnGrowth(size_t /*size*/, size_t /*new_capacity*/, const std::source_location& /*site*/) noexcept {
+    }
+};
+
+template <typename T, typename Allocator = std::allocator<T>, typename Stats = NoStats>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+        "Allocator::value_type must be the same as T");
+
 public:
-    RawMemory() = default;
+    using allocator_type = Allocator;
+
+    // Аллокатор умеет изменять размер блока без выделения новой памяти и переноса элементов
+    static constexpr bool SUPPORTS_REALLOCATE = HasReallocate<Allocator>::value;
+
+    constexpr RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
-        , capacity_(capacity) {
+    constexpr explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    constexpr explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc) {
+        Allocate(capacity);
     }
     
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory(RawMemory&& other) noexcept {
-        Swap(other);
+    constexpr RawMemory(RawMemory&& other) noexcept
+        : alloc_(other.alloc_)
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
             Swap(rhs);
         }
         return *this;
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Обменивает буферы. Аллокаторы обмениваются, только если это разрешает
+    // propagate_on_container_swap, иначе они обязаны быть равны
+    constexpr void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    // Заменяет аллокатор пустого буфера. Используется при распространении аллокатора
+    // в операциях присваивания (propagate_on_container_copy/move_assignment)
+    constexpr void ReplaceAllocator(const Allocator& alloc) noexcept {
+        assert(buffer_ == nullptr);
+        alloc_ = alloc;
+    }
+
+    // Изменяет вместимость буфера средствами аллокатора (например, realloc), сохраняя
+    // его содержимое побайтово. Применимо только к тривиально перемещаемым элементам
+    constexpr void Reallocate(size_t new_capacity) {
+        static_assert(SUPPORTS_REALLOCATE, "Allocator does not support Reallocate");
+        if (buffer_ == nullptr) {
+            Allocate(new_capacity);
+        } else if (new_capacity == 0) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+            capacity_ = 0;
+        } else {
+            const auto [buf, count] = alloc_.Reallocate(buffer_, capacity_, new_capacity);
+            Stats::OnDeallocate(capacity_ * sizeof(T));
+            Stats::OnAllocate(count, count * sizeof(T));
+            buffer_ = buf;
+            capacity_ = count;
+        }
+    }
+
+    constexpr const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const {
         return capacity_;
     }
 
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    // Выделяет сырую память не менее чем под n элементов. Если аллокатор сообщает
+    // реальный размер блока, весь блок становится вместимостью буфера
+    constexpr void Allocate(size_t n) {
+        if (n == 0) {
+            return;
+        }
+        if constexpr (HasAllocateAtLeast<Allocator>::value) {
+            const auto [buf, count] = alloc_.AllocateAtLeast(n);
+            buffer_ = buf;
+            capacity_ = count;
+        } else {
+            buffer_ = AllocTraits::allocate(alloc_, n);
+            capacity_ = n;
+        }
+        Stats::OnAllocate(capacity_, capacity_ * sizeof(T));
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    constexpr void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+            Stats::OnDeallocate(n * sizeof(T));
+        }
     }
 
+    [[no_unique_address]] Allocator alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+// Алгоритмы над массивом элементов, общие для Vector и контейнеров со встроенным буфером.
+// data указывает на начало массива из size сконструированных элементов
+namespace vector_detail {
+
+// Аналоги алгоритмов для неинициализированной памяти, допустимые в константных
+// выражениях: стандартные алгоритмы станут constexpr только в C++26. Во время компиляции
+// элементы конструируются по одному через std::construct_at, а во время выполнения
+// вызываются стандартные алгоритмы
+template <typename T>
+constexpr void UninitializedValueConstructN(T* to, size_t count) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i) {
+            std::construct_at(to + i);
+        }
+    } else {
+        std::uninitialized_value_construct_n(to, count);
+    }
+}
+
+// Во время компиляции неинициализированные значения недопустимы, поэтому элементы
+// инициализируются значением
+template <typename T>
+constexpr void UninitializedDefaultConstructN(T* to, size_t count) {
+    if (std::is_constant_evaluated()) {
+        UninitializedValueConstructN(to, count);
+    } else {
+        std::uninitialized_default_construct_n(to, count);
+    }
+}
+
+template <typename InputIt, typename T>
+constexpr void UninitializedCopyN(InputIt first, size_t count, T* to) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i, ++first) {
+            std::construct_at(to + i, *first);
+        }
+    } else {
+        std::uninitialized_copy_n(first, count, to);
+    }
+}
+
+template <typename T>
+constexpr void UninitializedMoveN(T* from, size_t count, T* to) {
+    UninitializedCopyN(std::make_move_iterator(from), count, to);
+}
+
+// Переносит count тривиально перемещаемых элементов из from в to побайтово. Диапазоны
+// могут перекрываться: при forward to должен быть левее from, иначе правее. Во время
+// компиляции memmove недоступен, и элементы переносятся перемещением с разрушением исходных
+template <typename T>
+constexpr void RelocateBytewise(T* to, T* from, size_t count, bool forward = true) noexcept {
+    if (std::is_constant_evaluated()) {
+        if constexpr (std::is_move_constructible_v<T>) {
+            for (size_t i = 0; i < count; ++i) {
+                const size_t k = forward ? i : count - 1 - i;
+                std::construct_at(to + k, std::move(from[k]));
+                std::destroy_at(from + k);
+            }
+        }
+    } else if (count != 0) {
+        std::memmove(static_cast<void*>(to), from, count * sizeof(T));
+    }
+}
+
+// Элементы переносятся перемещением с возвратом перенесённых при исключении
+template <typename T>
+inline constexpr bool MOVES_WITH_ROLLBACK = !IsTriviallyRelocatableV<T>
+    && !std::is_nothrow_move_constructible_v<T> && IsRollbackRelocatableV<T>;
+
+// Элементы переносятся перемещением (иначе копированием)
+template <typename T>
+inline constexpr bool RELOCATES_BY_MOVE = std::is_nothrow_move_constructible_v<T>
+    || MOVES_WITH_ROLLBACK<T> || !std::is_copy_constructible_v<T>;
+
+// Отменяет завершившийся ConstructRelocated: возвращает перемещённые с откатом элементы
+// в from и разрушает элементы в to
+template <typename T>
+constexpr void UndoConstructRelocated(T* from, size_t count, T* to) noexcept {
+    if constexpr (MOVES_WITH_ROLLBACK<T>) {
+        for (size_t i = 0; i < count; ++i) {
+            from[i] = std::move(to[i]);
+        }
+    }
+    std::destroy_n(to, count);
+}
+
+// Конструирует в неинициализированной памяти to элементы, перенесённые из from, не
+// разрушая исходные. Если конструирование бросит исключение, созданные элементы
+// разрушаются, а перемещённые с откатом возвращаются в from
+template <typename T>
+constexpr void ConstructRelocated(T* from, size_t count, T* to) {
+    if constexpr (MOVES_WITH_ROLLBACK<T>) {
+        size_t done = 0;
+        try {
+            for (; done < count; ++done) {
+                std::construct_at(to + done, std::move(from[done]));
+            }
+        } catch (...) {
+            UndoConstructRelocated(from, done, to);
+            throw;
+        }
+    } else if constexpr (RELOCATES_BY_MOVE<T>) {
+        UninitializedMoveN(from, count, to);
+    } else {
+        UninitializedCopyN(from, count, to);
+    }
+}
+
+// Сообщает политике статистики о переносе count элементов
+template <typename Stats, typename T>
+constexpr void OnRelocated(size_t count) noexcept {
+    if constexpr (IsTriviallyRelocatableV<T> || RELOCATES_BY_MOVE<T>) {
+        Stats::OnRelocate(count, 0);
+    } else {
+        Stats::OnRelocate(0, count);
+    }
+}
+
+// Переносит count элементов из from в неинициализированную память to и разрушает исходные.
+// Если перенос бросит исключение, элементы from остаются нетронутыми
+template <typename Stats = NoStats, typename T>
+constexpr void MoveItemsInNewMemory(T* from, T* to, size_t count) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        // Переносим элементы одним проходом по памяти, исходные объекты не разрушаются
+        RelocateBytewise(to, from, count);
+    } else {
+        ConstructRelocated(from, count, to);
+        // Разрушаем элементы в from
+        std::destroy_n(from, count);
+    }
+    OnRelocated<Stats, T>(count);
+}
+
+// Переносит элементы from в to, оставляя в to ячейки [index, index + count)
+// неинициализированными, и разрушает исходные. Перед вызовом ячейки разрыва должны быть
+// заполнены: если перенос бросит исключение, они разрушаются, а элементы from остаются нетронутыми
+template <typename Stats = NoStats, typename T>
+constexpr void MoveItemsAroundGap(T* from, size_t size, T* to, size_t index, size_t count) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        MoveItemsInNewMemory<Stats>(from, to, index);
+        MoveItemsInNewMemory<Stats>(from + index, to + index + count, size - index);
+    } else {
+        try {
+            ConstructRelocated(from, index, to);
+            try {
+                ConstructRelocated(from + index, size - index, to + index + count);
+            } catch (...) {
+                UndoConstructRelocated(from, index, to);
+                throw;
+            }
+        } catch (...) {
+            std::destroy_n(to + index, count);
+            throw;
+        }
+        std::destroy_n(from, size);
+        OnRelocated<Stats, T>(size);
+    }
+}
+
+// Сдвигает тривиально перемещаемые элементы, начиная с index, на одну позицию вправо
+// и переносит в освободившуюся ячейку объект, сконструированный в item
+template <typename T>
+void PlaceRelocated(T* data, size_t size, size_t index, const std::byte* item) noexcept {
+    T* hole = data + index;
+    std::memmove(static_cast<void*>(hole + 1), hole, (size - index) * sizeof(T));
+    std::memcpy(static_cast<void*>(hole), item, sizeof(T));
+}
+
+// Переносит элементы [index, size) на одну позицию вправо перемещающим конструированием,
+// оставляя ячейку index неинициализированной. За последним элементом должна быть свободная ячейка
+template <typename T>
+constexpr void OpenGap(T* data, size_t size, size_t index) noexcept {
+    for (size_t i = size; i > index; --i) {
+        std::construct_at(data + i, std::move(data[i - 1]));
+        std::destroy_at(data + i - 1);
+    }
+}
+
+// Обратная к OpenGap операция: закрывает неинициализированную ячейку index
+template <typename T>
+constexpr void CloseGap(T* data, size_t size, size_t index) noexcept {
+    for (size_t i = index; i < size; ++i) {
+        std::construct_at(data + i, std::move(data[i + 1]));
+        std::destroy_at(data + i + 1);
+    }
+}
+
+// Элемент можно сконструировать прямо в ячейке, освобождённой сдвигом хвоста: сдвиг
+// не бросает исключений и при неудаче конструирования откатывается. Аргумент
+// не должен пострадать от сдвига, поэтому так конструируется только элемент из одного
+// объекта типа T, адрес которого пересчитывается, если он лежит в сдвигаемом хвосте.
+// Прочие аргументы (указатели, string_view, ссылки на поля элементов) могут указывать
+// в сдвигаемые элементы, и элемент из них конструируется во временном объекте до сдвига
+template <typename T, typename... Args>
+inline constexpr bool CAN_CONSTRUCT_IN_GAP = std::is_nothrow_move_constructible_v<T>
+    && sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...);
+
+// Конструирует элемент из объекта arg типа T в ячейке index, сдвигая хвост
+template <typename T, typename Arg>
+constexpr void ConstructInGap(T* data, size_t size, size_t index, Arg&& arg) {
+    if (std::is_constant_evaluated()) {
+        // Во время компиляции адреса разных объектов несравнимы, поэтому элемент
+        // создаётся до сдвига во временном объекте
+        T temp(static_cast<Arg&&>(arg));
+        OpenGap(data, size, index);
+        std::construct_at(data + index, std::move(temp));
+        return;
+    }
+    T* source = const_cast<T*>(std::addressof(arg));
+    // Аргумент может быть элементом хвоста, который сдвинется на одну позицию
+    const std::less<const T*> less;
+    if (!less(source, data + index) && less(source, data + size)) {
+        ++source;
+    }
+    OpenGap(data, size, index);
+    try {
+        std::construct_at(data + index, static_cast<Arg&&>(*source));
+    } catch (...) {
+        CloseGap(data, size, index);
+        throw;
+    }
+}
+
+// Вставляет элемент в позицию index. За последним элементом должна быть свободная ячейка
+template <typename T, typename... Args>
+constexpr void InsertInPlace(T* data, size_t size, size_t index, Args&&... args) {
+    if (index == size) {
+        std::construct_at(data + size, std::forward<Args>(args)...);
+    } else if constexpr (IsTriviallyRelocatableV<T>) {
+        // Элемент создаётся во временном буфере до сдвига, поэтому исключение
+        // из конструктора оставит массив нетронутым
+        if (std::is_constant_evaluated()) {
+            T temp(std::forward<Args>(args)...);
+            RelocateBytewise(data + index + 1, data + index, size - index, false);
+            std::construct_at(data + index, std::move(temp));
+        } else {
+            alignas(T) std::byte temp[sizeof(T)];
+            new (temp) T(std::forward<Args>(args)...);
+            PlaceRelocated(data, size, index, temp);
+        }
+    } else if constexpr (CAN_CONSTRUCT_IN_GAP<T, Args...>) {
+        ConstructInGap(data, size, index, std::forward<Args>(args)...);
+    } else if constexpr (std::is_nothrow_move_constructible_v<T> && !std::is_move_assignable_v<T>) {
+        // Тип без присваивания: элемент создаётся до сдвига, а хвост сдвигается перемещающим конструированием
+        T temp(std::forward<Args>(args)...);
+        OpenGap(data, size, index);
+        std::construct_at(data + index, std::move(temp));
+    } else {
+        T temp (std::forward<Args>(args)...);
+        std::construct_at(data + size, std::move(*(data + size -  1)));
+        std::move_backward(data + index, data + size - 1, data + size);
+        *(data + index) = std::move(temp);
+    }
+}
+
+// Конструирует элемент в позиции index нового буфера to и переносит туда элементы из from
+template <typename Stats = NoStats, typename T, typename... Args>
+constexpr void InsertInNewMemory(T* from, size_t size, T* to, size_t index, Args&&... args) {
+    std::construct_at(to + index, std::forward<Args>(args)...);
+    MoveItemsAroundGap<Stats>(from, size, to, index, 1);
+}
+
+// Вставляет count элементов из first в позицию index, сдвигая хвост один раз.
+// За последним элементом должно быть не меньше count свободных ячеек, а first
+// не должен указывать на элементы массива. Если копирование бросает исключение,
+// массив остаётся из size корректных элементов, часть которых может быть перемещена
+template <typename T, typename ForwardIt>
+constexpr void InsertRangeInPlace(T* data, size_t size, size_t index, ForwardIt first, size_t count) {
+    T* pos = data + index;
+    const size_t elems_after = size - index;
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        RelocateBytewise(pos + count, pos, elems_after, false);
+        try {
+            UninitializedCopyN(first, count, pos);
+        } catch (...) {
+            RelocateBytewise(pos, pos + count, elems_after);
+            throw;
+        }
+    } else if (elems_after > count) {
+        UninitializedMoveN(data + size - count, count, data + size);
+        try {
+            std::move_backward(pos, data + size - count, data + size);
+            std::copy_n(first, count, pos);
+        } catch (...) {
+            std::destroy_n(data + size, count);
+            throw;
+        }
+    } else {
+        const ForwardIt mid = std::next(first, elems_after);
+        UninitializedCopyN(mid, count - elems_after, data + size);
+        try {
+            UninitializedMoveN(pos, elems_after, data + index + count);
+        } catch (...) {
+            std::destroy_n(data + size, count - elems_after);
+            throw;
+        }
+        try {
+            std::copy_n(first, elems_after, pos);
+        } catch (...) {
+            std::destroy_n(data + size, count);
+            throw;
+        }
+    }
+}
+
+// Конструирует count элементов из first начиная с позиции index нового буфера to
+// и переносит туда элементы из from
+template <typename Stats = NoStats, typename T, typename ForwardIt>
+constexpr void InsertRangeInNewMemory(T* from, size_t size, T* to, size_t index, ForwardIt first, size_t count) {
+    UninitializedCopyN(first, count, to + index);
+    MoveItemsAroundGap<Stats>(from, size, to, index, count);
+}
+
+// Итератор, многократно возвращающий одно и то же значение. Позволяет вставлять
+// count копий значения через алгоритмы вставки диапазона
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    constexpr RepeatIterator() = default;
+
+    constexpr explicit RepeatIterator(const T& value, size_t index = 0) noexcept
+        : value_(&value)
+        , index_(index) {
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *value_;
+    }
+
+    constexpr pointer operator->() const noexcept {
+        return value_;
+    }
+
+    constexpr RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    constexpr RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    constexpr bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+private:
+    const T* value_ = nullptr;
+    size_t index_ = 0;
+};
+
+// Удаляет элемент в позиции index, сдвигая последующие элементы влево
+template <typename T>
+constexpr void Erase(T* data, size_t size, size_t index) noexcept(
+        IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        T* hole = data + index;
+        std::destroy_at(hole);
+        RelocateBytewise(hole, hole + 1, size - index - 1);
+    } else {
+        std::move(data + index + 1, data + size, data + index);
+        std::destroy_n(data + size - 1, 1);
+    }
+}
+
+// Удаляет count элементов, начиная с позиции index, одним сдвигом хвоста
+template <typename T>
+constexpr void EraseRange(T* data, size_t size, size_t index, size_t count) noexcept(
+        IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        T* first = data + index;
+        std::destroy_n(first, count);
+        RelocateBytewise(first, first + count, size - index - count);
+    } else {
+        std::move(data + index + count, data + size, data + index);
+        std::destroy_n(data + size - count, count);
+    }
+}
+
+// Удаляет элемент в позиции index, перенося на его место последний элемент
 template <typename T>
+constexpr void EraseUnordered(T* data, size_t size, size_t index) noexcept(
+        IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+    T* hole = data + index;
+    T* last = data + size - 1;
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        std::destroy_at(hole);
+        if (hole != last) {
+            RelocateBytewise(hole, last, 1);
+        }
+    } else {
+        if (hole != last) {
+            *hole = std::move(*last);
+        }
+        std::destroy_at(last);
+    }
+}
+
+// Минимальное число элементов на поток, начиная с которого параллельные операции
+// используют несколько потоков при автоматическом выборе их числа
+inline constexpr size_t PARALLEL_MIN_CHUNK = size_t{1} << 15;
+
+// Число потоков для обработки count элементов. При threads == 0 оно определяется по числу
+// ядер и размеру массива, иначе ограничивается только числом элементов
+inline size_t ParallelWorkers(size_t threads, size_t count) noexcept {
+    if (threads == 0) {
+        const size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+        threads = std::min(cores, count / PARALLEL_MIN_CHUNK);
+    }
+    return std::clamp<size_t>(threads, 1, std::max<size_t>(count, 1));
+}
+
+// Делит [0, count) на workers частей и вызывает process(first, last) для каждой части:
+// первая часть обрабатывается в вызывающем потоке, остальные — в отдельных. Если поток
+// создать не удалось, его часть обрабатывается в вызывающем потоке.
+// Если обработка хотя бы одной части бросит исключение, для успешно обработанных частей
+// вызывается rollback(first, last), и исключение первой неудавшейся части пробрасывается
+// дальше. Неудавшаяся часть должна сама откатывать свои изменения
+template <typename Process, typename Rollback>
+void ForEachChunk(size_t count, size_t workers, Process process, Rollback rollback) {
+    std::unique_ptr<std::thread[]> threads;
+    std::unique_ptr<std::exception_ptr[]> errors;
+    if (workers > 1) {
+        threads.reset(new (std::nothrow) std::thread[workers - 1]);
+        errors.reset(new (std::nothrow) std::exception_ptr[workers]);
+    }
+    if (threads == nullptr || errors == nullptr) {
+        process(size_t{0}, count);
+        return;
+    }
+    const auto chunk_begin = [count, workers](size_t chunk) {
+        return count / workers * chunk + std::min(chunk, count % workers);
+    };
+    const auto run = [&](size_t chunk) noexcept {
+        try {
+            process(chunk_begin(chunk), chunk_begin(chunk + 1));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    for (size_t chunk = 1; chunk < workers; ++chunk) {
+        try {
+            threads[chunk - 1] = std::thread(run, chunk);
+        } catch (const std::system_error&) {
+            run(chunk);
+        }
+    }
+    run(0);
+    for (size_t i = 0; i + 1 < workers; ++i) {
+        if (threads[i].joinable()) {
+            threads[i].join();
+        }
+    }
+    const auto failed = std::find_if(errors.get(), errors.get() + workers, [](const std::exception_ptr& error) {
+        return error != nullptr;
+    });
+    if (failed == errors.get() + workers) {
+        return;
+    }
+    for (size_t chunk = 0; chunk < workers; ++chunk) {
+        if (errors[chunk] == nullptr) {
+            rollback(chunk_begin(chunk), chunk_begin(chunk + 1));
+        }
+    }
+    std::rethrow_exception(*failed);
+}
+
+// Параллельные варианты алгоритмов конструирования и разрушения массива. workers — число
+// потоков (см. ParallelWorkers). При исключении уже сконструированные элементы разрушаются
+
+template <typename T>
+void ParallelValueConstruct(T* data, size_t count, size_t workers) {
+    ForEachChunk(count, workers, [data](size_t first, size_t last) {
+        std::uninitialized_value_construct(data + first, data + last);
+    }, [data](size_t first, size_t last) noexcept {
+        std::destroy(data + first, data + last);
+    });
+}
+
+template <typename T>
+void ParallelCopy(const T* from, size_t count, T* to, size_t workers) {
+    ForEachChunk(count, workers, [from, to](size_t first, size_t last) {
+        std::uninitialized_copy(from + first, from + last, to + first);
+    }, [to](size_t first, size_t last) noexcept {
+        std::destroy(to + first, to + last);
+    });
+}
+
+template <typename T>
+void ParallelDestroy(T* data, size_t count, size_t workers) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        ForEachChunk(count, workers, [data](size_t first, size_t last) noexcept {
+            std::destroy(data + first, data + last);
+        }, [](size_t /*first*/, size_t /*last*/) noexcept {
+        });
+    }
+}
+
+// Параллельный вариант MoveItemsInNewMemory. Исходные элементы разрушаются только после
+// того, как сконструированы все новые, поэтому исключение при копировании их не затрагивает
+template <typename Stats = NoStats, typename T>
+void ParallelMoveItemsInNewMemory(T* from, T* to, size_t count, size_t workers) {
+    if constexpr (IsTriviallyRelocatableV<T>) {
+        ForEachChunk(count, workers, [from, to](size_t first, size_t last) noexcept {
+            if (first != last) {
+                std::memcpy(static_cast<void*>(to + first), from + first, (last - first) * sizeof(T));
+            }
+        }, [](size_t /*first*/, size_t /*last*/) noexcept {
+        });
+        Stats::OnRelocate(count, 0);
+    } else {
+        if constexpr (RELOCATES_BY_MOVE<T>) {
+            // Неудавшийся фрагмент откатывает себя сам, а готовые фрагменты откатываются здесь
+            ForEachChunk(count, workers, [from, to](size_t first, size_t last) {
+                ConstructRelocated(from + first, last - first, to + first);
+            }, [from, to](size_t first, size_t last) noexcept {
+                UndoConstructRelocated(from + first, last - first, to + first);
+            });
+        } else {
+            ParallelCopy(from, count, to, workers);
+        }
+        OnRelocated<Stats, T>(count);
+        ParallelDestroy(from, count, workers);
+    }
+}
+
+#ifdef VECTOR_DEBUG_ITERATORS
+// Состояние вектора, общее с его итераторами. Итераторы продлевают ему жизнь, поэтому
+// обращение через итератор разрушенного вектора тоже обнаруживается
+struct IteratorState {
+    const void* owner = nullptr;
+    // Увеличивается, когда итераторы вектора становятся недействительными
+    size_t generation = 0;
+};
+
+[[noreturn]] inline void DebugFailure(const char* message) noexcept {
+    std::cerr << "Vector: " << message << std::endl;
+    std::abort();
+}
+#endif
+
+}  // namespace vector_detail
+
+// Тег конструктора, создающего элементы инициализацией по умолчанию. Для тривиальных
+// типов это означает, что память не заполняется нулями
+struct ForOverwriteTag {
+    explicit ForOverwriteTag() = default;
+};
+
+inline constexpr ForOverwriteTag FOR_OVERWRITE{};
+
+// Тег параллельных вариантов операций. threads задаёт число потоков, 0 — выбрать
+// по числу ядер и размеру вектора. Небольшие векторы обрабатываются в вызывающем потоке
+struct ParallelTag {
+    size_t threads = 0;
+};
+
+inline constexpr ParallelTag PARALLEL{};
+
+// Разделяемый неизменяемый вектор с копированием при записи, объявлен в shared_vector.h
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+    typename Stats = NoStats>
+class SharedVector;
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+    typename Stats = NoStats>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Storage = RawMemory<T, Allocator, Stats>;
+
+    // Буфер можно расширять на месте: элементы переносятся вместе с блоком побайтово
+    static constexpr bool CAN_REALLOCATE =
+        IsTriviallyRelocatableV<T> && Storage::SUPPORTS_REALLOCATE;
+
 public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
     Vector() = default;
+
+    constexpr explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc) {
+    }
     
-    explicit Vector(size_t size)
-        : data_(size)
+    constexpr explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+        , size_(size)  //
+    {
+        vector_detail::UninitializedValueConstructN(data_.GetAddress(), size);
+    }
+
+    constexpr Vector(std::initializer_list<T> items, const Allocator& alloc = Allocator())
+        : data_(items.size(), alloc)
+        , size_(items.size())  //
+    {
+        vector_detail::UninitializedCopyN(items.begin(), size_, data_.GetAddress());
+    }
+
+    constexpr Vector(ForOverwriteTag, size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
         , size_(size)  //
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        vector_detail::UninitializedDefaultConstructN(data_.GetAddress(), size);
     }
     
-    Vector(const Vector& other)
-        : data_(other.size_)
+    constexpr Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    // Параллельные варианты конструкторов для больших векторов. Части буфера
+    // заполняются разными потоками, поэтому при политике first-touch страницы буфера
+    // распределяются по узлам NUMA этих потоков
+    Vector(ParallelTag policy, size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)  //
+    {
+        vector_detail::ParallelValueConstruct(data_.GetAddress(), size, Workers(policy, size));
+        size_ = size;
+    }
+
+    Vector(ParallelTag policy, const Vector& other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))  //
+    {
+        vector_detail::ParallelCopy(other.data_.GetAddress(), other.size_, data_.GetAddress(),
+            Workers(policy, other.size_));
+        size_ = other.size_;
+    }
+
+    constexpr Vector(const Vector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_) //
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        vector_detail::UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
     }
     
-    Vector(Vector&& other) noexcept {
-        Swap(other);
+    constexpr Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0)) {
+        other.InvalidateIterators();
+    }
+
+    constexpr Vector(Vector&& other, const Allocator& alloc)
+        : data_(alloc) {
+        if (AllocTraits::is_always_equal::value || alloc == other.GetAllocator()) {
+            data_.Swap(other.data_);
+            std::swap(size_, other.size_);
+        } else {
+            // Память other принадлежит другому ресурсу, поэтому элементы приходится перемещать
+            Storage new_data(other.size_, alloc);
+            vector_detail::UninitializedMoveN(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+        }
+        other.InvalidateIterators();
     }
     
-    Vector& operator=(const Vector& rhs) {
+    constexpr Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
-            if (rhs.size_ > data_.Capacity()) {
-                Vector temp (rhs);
-                Swap(temp);
-            } else {
-                std::copy_n(
-                    rhs.data_.GetAddress(),
-                    std::min(rhs.size_, size_),
-                    data_.GetAddress());
-                std::uninitialized_copy_n(
-                    rhs.data_.GetAddress() + std::min(rhs.size_, size_), 
-                    rhs.size_ - std::min(rhs.size_, size_), 
-                    data_.GetAddress() + std::min(rhs.size_, size_));
-                if (rhs.size_<size_) {
-                    std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                    && !AllocTraits::is_always_equal::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Память, выделенную старым аллокатором, нужно вернуть ему же
+                    Vector temp(rhs, rhs.GetAllocator());
+                    ReleaseStorage();
+                    data_.ReplaceAllocator(rhs.GetAllocator());
+                    Swap(temp);
+                    return *this;
                 }
-                size_ = rhs.size_;
             }
+            AssignElements(rhs.data_.GetAddress(), rhs.size_);
         }
         return *this;
     }
     
-    Vector& operator=(Vector&& rhs) noexcept {
+    constexpr Vector& operator=(Vector&& rhs) noexcept(
+            AllocTraits::propagate_on_container_move_assignment::value
+            || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                if (!AllocTraits::is_always_equal::value && GetAllocator() != rhs.GetAllocator()) {
+                    ReleaseStorage();
+                    data_.ReplaceAllocator(rhs.GetAllocator());
+                }
+                Swap(rhs);
+            } else if (AllocTraits::is_always_equal::value || GetAllocator() == rhs.GetAllocator()) {
+                Swap(rhs);
+            } else {
+                // Аллокаторы не распространяются и не равны: буфер rhs забрать нельзя
+                if constexpr (std::is_trivially_copyable_v<T>) {
+                    AssignElements(rhs.data_.GetAddress(), rhs.size_);
+                } else {
+                    AssignElements(std::make_move_iterator(rhs.data_.GetAddress()), rhs.size_);
+                }
+            }
         }
         return *this;
     }
     
-    ~Vector() {
+    constexpr ~Vector() {
         std::destroy_n(data_.GetAddress(), size_);
+#ifdef VECTOR_DEBUG_ITERATORS
+        if (iterator_state_ != nullptr) {
+            iterator_state_->owner = nullptr;
+            ++iterator_state_->generation;
+        }
+#endif
     }
     
-    void Swap(Vector& other) noexcept {
+    // Итераторы обоих векторов становятся недействительными (строже, чем у std::vector)
+    constexpr void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+        InvalidateIterators();
+        other.InvalidateIterators();
     }
+
+    constexpr Allocator GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Передаёт буфер с элементами в разделяемый неизменяемый вектор без копирования
+    // элементов, оставляя этот вектор пустым. Определена в shared_vector.h
+    SharedVector<T, Allocator, GrowthPolicy, Stats> Freeze() &&;
     
-    void Reserve(size_t new_capacity) {
+    constexpr void Reserve(size_t new_capacity) {
+        // Размер не больше вместимости. Без этой подсказки GCC после встраивания рассматривает
+        // перенос size_ элементов в буфер на new_capacity как возможный выход за его границу
+        // и при -O2 выдаёт -Warray-bounds и -Wstringop-overflow
+        if (size_ > Capacity()) {
+            __builtin_unreachable();
+        }
         if (new_capacity <= Capacity()) {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
-        MoveItemsInNewMemory(data_.GetAddress(), new_data.GetAddress(), size_);
-        data_.Swap(new_data);
+        Stats::OnReallocate(Capacity(), new_capacity);
+        if constexpr (CAN_REALLOCATE) {
+            data_.Reallocate(new_capacity);
+        } else {
+            Storage new_data(new_capacity, data_.GetAllocator());
+            vector_detail::MoveItemsInNewMemory<Stats>(data_.GetAddress(), new_data.GetAddress(), size_);
+            data_.Swap(new_data);
+        }
+        InvalidateIterators();
     }
     
-    void Resize(size_t new_size) {
+    // Как Reserve, но элементы переносятся в новый буфер несколькими потоками
+    void Reserve(ParallelTag policy, size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Stats::OnReallocate(Capacity(), new_capacity);
+        if constexpr (CAN_REALLOCATE) {
+            data_.Reallocate(new_capacity);
+        } else {
+            Storage new_data(new_capacity, data_.GetAllocator());
+            vector_detail::ParallelMoveItemsInNewMemory<Stats>(data_.GetAddress(), new_data.GetAddress(), size_,
+                Workers(policy, size_));
+            data_.Swap(new_data);
+        }
+        InvalidateIterators();
+    }
+
+    // Уменьшает вместимость до размера вектора, возвращая лишнюю память аллокатору.
+    // Если аллокатор умеет изменять размер блока, буфер сжимается на месте
+    constexpr void ShrinkToFit() {
+        if (Capacity() == size_) {
+            return;
+        }
+        Stats::OnReallocate(Capacity(), size_);
+        if constexpr (CAN_REALLOCATE) {
+            data_.Reallocate(size_);
+        } else {
+            Storage new_data(size_, data_.GetAllocator());
+            vector_detail::MoveItemsInNewMemory<Stats>(data_.GetAddress(), new_data.GetAddress(), size_);
+            data_.Swap(new_data);
+        }
+        InvalidateIterators();
+    }
+
+    // Разрушает все элементы, сохраняя вместимость
+    constexpr void Clear() noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        InvalidateIterators();
+    }
+
+    // Как Clear, но элементы разрушаются несколькими потоками. Деструктор вектора
+    // разрушает элементы в одном потоке, поэтому большой вектор стоит очищать перед ним
+    void Clear(ParallelTag policy) noexcept {
+        vector_detail::ParallelDestroy(data_.GetAddress(), size_, Workers(policy, size_));
+        size_ = 0;
+        InvalidateIterators();
+    }
+
+    // Уменьшение размера делает недействительными все итераторы: проверка поколений
+    // не отличает итераторы на разрушенные элементы от прочих
+    constexpr void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            InvalidateIterators();
+        }
+        if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(new_size);
+            }
+            vector_detail::UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    // Как Resize, но элементы конструируются, переносятся и разрушаются несколькими потоками
+    void Resize(ParallelTag policy, size_t new_size) {
+        if (new_size < size_) {
+            vector_detail::ParallelDestroy(data_.GetAddress() + new_size, size_ - new_size,
+                Workers(policy, size_ - new_size));
+            InvalidateIterators();
+        }
+        if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(policy, new_size);
+            }
+            vector_detail::ParallelValueConstruct(data_.GetAddress() + size_, new_size - size_,
+                Workers(policy, new_size - size_));
+        }
+        size_ = new_size;
+    }
+
+    // Как Resize, но новые элементы инициализируются по умолчанию: память под элементы
+    // тривиальных типов остаётся незаполненной и предназначена для перезаписи (например, read())
+    constexpr void ResizeForOverwrite(size_t new_size) {
         if (new_size < size_) {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            InvalidateIterators();
         }
         if (new_size > size_) {
             if (new_size > Capacity()) {
                 Reserve(new_size);
             }
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            vector_detail::UninitializedDefaultConstructN(data_.GetAddress() + size_, new_size - size_);
         }
         size_ = new_size;
     }
+
+    // Добавляет в конец count элементов, инициализированных по умолчанию, и возвращает их.
+    // Вместимость растёт по политике роста, поэтому серия добавлений амортизирована
+    constexpr std::span<T> AppendUninitialized(size_t count) {
+        if (size_ + count > Capacity()) {
+            Reserve(GrowthPolicy::NextCapacity(Capacity(), size_ + count, sizeof(T)));
+        }
+        T* first = data_.GetAddress() + size_;
+        vector_detail::UninitializedDefaultConstructN(first, count);
+        size_ += count;
+        return {first, count};
+    }
     
-    void PushBack(const T& value) {
-        EmplaceBack(value);
+    constexpr void PushBack(const T& value, std::source_location site = std::source_location::current()) {
+        EmplaceAt(size_, site, value);
     }
-    void PushBack(T&& value) {
-        EmplaceBack(std::move(value));
+    constexpr void PushBack(T&& value, std::source_location site = std::source_location::current()) {
+        EmplaceAt(size_, site, std::move(value));
     }
     
-    void PopBack() noexcept {
+    constexpr void PopBack() noexcept {
+        assert(size_ > 0);
         --size_;
         std::destroy_at(data_.GetAddress() + size_);
     }
     
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
-        Emplace(begin() + size_, std::forward<Args>(args)...);
+    constexpr T& EmplaceBack(Args&&... args) {
+        // За пакетом аргументов нельзя добавить параметр со значением по умолчанию, поэтому
+        // местом вызова считается сам EmplaceBack: имя функции в site содержит тип элемента
+        // и типы аргументов. Чтобы учитывать место вызова, используйте EmplaceBackAt
+        EmplaceAt(size_, std::source_location::current(), std::forward<Args>(args)...);
+        return data_[size_ - 1];
+    }
+
+    // Как EmplaceBack, но рост вектора учитывается в месте вызова site:
+    //     v.EmplaceBackAt(std::source_location::current(), key, value);
+    template <typename... Args>
+    constexpr T& EmplaceBackAt(const std::source_location& site, Args&&... args) {
+        EmplaceAt(size_, site, std::forward<Args>(args)...);
         return data_[size_ - 1];
     }
     
-    size_t Size() const noexcept {
+    constexpr size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    constexpr size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
+#ifdef VECTOR_DEBUG_ITERATORS
+        if (index >= size_) {
+            vector_detail::DebugFailure("index is out of range");
+        }
+#else
         assert(index < size_);
+#endif
         return data_.GetAddress()[index];
     }
 
+    // Доступ с проверкой индекса в любом режиме сборки
+    constexpr const T& At(size_t index) const {
+        return const_cast<Vector&>(*this).At(index);
+    }
+
+    constexpr T& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Vector::At: index is out of range");
+        }
+        return data_.GetAddress()[index];
+    }
+
+    // Адрес буфера с элементами. Выравнивание буфера определяется аллокатором
+    constexpr const T* GetAddress() const noexcept {
+        return data_.GetAddress();
+    }
+
+    constexpr T* GetAddress() noexcept {
+        return data_.GetAddress();
+    }
+
+#ifdef VECTOR_DEBUG_ITERATORS
+    template <bool IsConst>
+    class CheckedIterator;
+
+    using iterator = CheckedIterator<false>;
+    using const_iterator = CheckedIterator<true>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
+#endif
     
-    iterator begin() noexcept {
-        return data_.GetAddress();
+    constexpr iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    constexpr iterator end() noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
-    const_iterator begin() const noexcept {
+    constexpr const_iterator begin() const noexcept {
         return cbegin();
     }
-    const_iterator end() const noexcept {
+    constexpr const_iterator end() const noexcept {
         return cend();
     }
-    const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+    constexpr const_iterator cbegin() const noexcept {
+        return MakeIterator(data_.GetAddress());
     }
-    const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+    constexpr const_iterator cend() const noexcept {
+        return MakeIterator(data_.GetAddress() + size_);
     }
 
-    template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args) {
-        size_t index = pos - begin();
-        if (size_ == Capacity() || index == Capacity()) {
-            InsertWithReallocate(index, std::forward<Args>(args)...);
-        } else {
-            InsertInPlace(index, std::forward<Args>(args)...);
+    // Позиция вставки вместе с местом вызова. Неявно создаётся из итератора в точке вызова
+    // Emplace, поэтому site указывает на вызывающий код
+    struct EmplacePosition {
+        template <typename It>
+            requires std::convertible_to<It, const_iterator>
+        constexpr EmplacePosition(It it, std::source_location site = std::source_location::current()) noexcept
+            : pos(it)
+            , site(site) {
         }
-        ++size_;
+
+        const_iterator pos;
+        std::source_location site;
+    };
+
+    template <typename... Args>
+    constexpr iterator Emplace(EmplacePosition pos, Args&&... args) {
+        size_t index = IndexOf(pos.pos);
+        EmplaceAt(index, pos.site, std::forward<Args>(args)...);
         return begin() + index;
     }
     
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
-        size_t index = pos - begin();
-        std::move(begin() + index + 1, end(), begin() + index);
-        std::destroy_n(data_.GetAddress() + size_ - 1, 1);
+    constexpr iterator Erase(const_iterator pos) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        size_t index = IndexOf(pos);
+#ifdef VECTOR_DEBUG_ITERATORS
+        if (index == size_) {
+            vector_detail::DebugFailure("Erase of end()");
+        }
+#endif
+        vector_detail::Erase(data_.GetAddress(), size_, index);
         --size_;
+        if (index != size_) {
+            InvalidateIterators();
+        }
         return begin() + index;
     }
     
-    iterator Insert(const_iterator pos, const T& value) {
-        return Emplace(pos, value);
+    // Удаляет элементы [first, last) одним сдвигом хвоста
+    constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        size_t index = IndexOf(first);
+        size_t count = IndexOf(last) - index;
+        if (count != 0) {
+            vector_detail::EraseRange(data_.GetAddress(), size_, index, count);
+            size_ -= count;
+            if (index != size_) {
+                InvalidateIterators();
+            }
+        }
+        return begin() + index;
     }
-    iterator Insert(const_iterator pos, T&& value) {
-        return Emplace(pos, std::move(value));
+
+    // Удаляет элемент за O(1), перенося на его место последний элемент.
+    // Порядок элементов не сохраняется
+    constexpr iterator EraseUnordered(const_iterator pos) noexcept(
+            IsTriviallyRelocatableV<T> || std::is_nothrow_move_assignable_v<T>) {
+        size_t index = IndexOf(pos);
+        vector_detail::EraseUnordered(data_.GetAddress(), size_, index);
+        --size_;
+        InvalidateIterators();
+        return begin() + index;
     }
+
+    // Удаляет все элементы, удовлетворяющие pred, за один проход и возвращает их количество
+    template <typename Predicate>
+    constexpr size_t EraseIf(Predicate pred) {
+        const iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t count = end() - new_end;
+        std::destroy_n(new_end, count);
+        size_ -= count;
+        if (count != 0) {
+            InvalidateIterators();
+        }
+        return count;
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value, std::source_location site = std::source_location::current()) {
+        return Emplace(EmplacePosition(pos, site), value);
+    }
+    constexpr iterator Insert(const_iterator pos, T&& value, std::source_location site = std::source_location::current()) {
+        return Emplace(EmplacePosition(pos, site), std::move(value));
+    }
+
+    // Вставляет count копий value. value может ссылаться на элемент самого вектора
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        size_t index = IndexOf(pos);
+        const T copy(value);
+        InsertRange(index, vector_detail::RepeatIterator<T>(copy), count);
+        return begin() + index;
+    }
+
+    // Вставляет элементы [first, last), которые не должны принадлежать вектору.
+    // Для однонаправленных итераторов память выделяется не более одного раза,
+    // а хвост сдвигается однократно
+    template <std::input_iterator InputIt>
+    constexpr iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        size_t index = IndexOf(pos);
+        if constexpr (std::forward_iterator<InputIt>) {
+            InsertRange(index, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // Длина диапазона заранее неизвестна: добавляем элементы в конец и поворачиваем хвост
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            if (index != old_size) {
+                InvalidateIterators();
+            }
+        }
+        return begin() + index;
+    }
+
+    template <std::ranges::input_range Range>
+    constexpr void AppendRange(Range&& range) {
+        if constexpr (std::ranges::forward_range<Range>) {
+            InsertRange(size_, std::ranges::begin(range), static_cast<size_t>(std::ranges::distance(range)));
+        } else {
+            for (auto&& item : range) {
+                EmplaceBack(std::forward<decltype(item)>(item));
+            }
+        }
+    }
+
+#ifdef VECTOR_DEBUG_ITERATORS
+    // Итератор отладочного режима. Помимо позиции хранит состояние вектора и поколение,
+    // в котором получен. operator* и operator[] проверяют, что позиция указывает на элемент,
+    // а сдвиги, сравнения и operator-> — что итератор действителен и не вышел за [begin, end]
+    template <bool IsConst>
+    class CheckedIterator {
+    public:
+        using iterator_concept = std::contiguous_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+
+        CheckedIterator() = default;
+
+        // Неконстантный итератор неявно приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        CheckedIterator(const CheckedIterator<OtherConst>& other) noexcept
+            : state_(other.state_)
+            , ptr_(other.ptr_)
+            , generation_(other.generation_) {
+        }
+
+        reference operator*() const noexcept {
+            Check(true);
+            return *ptr_;
+        }
+        pointer operator->() const noexcept {
+            Check(false);
+            return ptr_;
+        }
+        reference operator[](difference_type offset) const noexcept {
+            return *(*this + offset);
+        }
+
+        CheckedIterator& operator++() noexcept {
+            return *this += 1;
+        }
+        CheckedIterator operator++(int) noexcept {
+            CheckedIterator old = *this;
+            *this += 1;
+            return old;
+        }
+        CheckedIterator& operator--() noexcept {
+            return *this -= 1;
+        }
+        CheckedIterator operator--(int) noexcept {
+            CheckedIterator old = *this;
+            *this -= 1;
+            return old;
+        }
+        CheckedIterator& operator+=(difference_type offset) noexcept {
+            Check(false);
+            const Vector& owner = Owner();
+            const difference_type index = ptr_ - owner.data_.GetAddress() + offset;
+            if (index < 0 || index > static_cast<difference_type>(owner.size_)) {
+                vector_detail::DebugFailure("iterator is moved out of range");
+            }
+            ptr_ += offset;
+            return *this;
+        }
+        CheckedIterator& operator-=(difference_type offset) noexcept {
+            return *this += -offset;
+        }
+
+        friend CheckedIterator operator+(CheckedIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+        friend CheckedIterator operator+(difference_type offset, CheckedIterator it) noexcept {
+            return it += offset;
+        }
+        friend CheckedIterator operator-(CheckedIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+        friend difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ - rhs.ptr_;
+        }
+
+        friend bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ == rhs.ptr_;
+        }
+        friend auto operator<=>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            CheckComparable(lhs, rhs);
+            return lhs.ptr_ <=> rhs.ptr_;
+        }
+
+    private:
+        friend class Vector;
+        friend class CheckedIterator<!IsConst>;
+
+        CheckedIterator(const std::shared_ptr<vector_detail::IteratorState>& state, pointer ptr) noexcept
+            : state_(state)
+            , ptr_(ptr)
+            , generation_(state->generation) {
+        }
+
+        const Vector& Owner() const noexcept {
+            return *static_cast<const Vector*>(state_->owner);
+        }
+
+        // Проверяет, что итератор действителен и указывает в [begin, end], а при
+        // dereference — что он указывает на элемент
+        void Check(bool dereference) const noexcept {
+            if (state_ == nullptr) {
+                vector_detail::DebugFailure("iterator is not bound to a vector");
+            }
+            if (state_->generation != generation_) {
+                vector_detail::DebugFailure(state_->owner == nullptr ? "vector of the iterator is destroyed"
+                                                                     : "iterator is invalidated");
+            }
+            const Vector& owner = Owner();
+            const T* first = owner.data_.GetAddress();
+            const T* last = first + owner.size_;
+            if (ptr_ < first || ptr_ > last || (dereference && ptr_ == last)) {
+                vector_detail::DebugFailure("iterator is out of range");
+            }
+        }
+
+        static void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+            if (lhs.state_ != rhs.state_) {
+                vector_detail::DebugFailure("iterators of different vectors are compared");
+            }
+            if (lhs.state_ != nullptr) {
+                lhs.Check(false);
+                rhs.Check(false);
+            }
+        }
+
+        std::shared_ptr<vector_detail::IteratorState> state_;
+        pointer ptr_ = nullptr;
+        size_t generation_ = 0;
+    };
+#endif
     
 private:
-    RawMemory<T> data_;
+    Storage data_;
     size_t size_ = 0;
-    
-    template <typename... Args>
-    void InsertWithReallocate(size_t index, Args&&... args) {
-        RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-        new (new_data.GetAddress() + index) T(std::forward<Args>(args)...);
-        MoveItemsInNewMemory(data_.GetAddress(), new_data.GetAddress(), index);
-        MoveItemsInNewMemory(data_.GetAddress() + index, new_data.GetAddress() + index + 1, size_ - index);
-        data_.Swap(new_data);
+#ifdef VECTOR_DEBUG_ITERATORS
+    // Создаётся при первом обращении к итераторам
+    mutable std::shared_ptr<vector_detail::IteratorState> iterator_state_;
+#endif
+
+#ifdef VECTOR_DEBUG_ITERATORS
+    const std::shared_ptr<vector_detail::IteratorState>& GetIteratorState() const {
+        if (iterator_state_ == nullptr) {
+            iterator_state_ = std::make_shared<vector_detail::IteratorState>();
+            iterator_state_->owner = this;
+        }
+        return iterator_state_;
     }
-    
+
+    iterator MakeIterator(T* ptr) noexcept {
+        return iterator(GetIteratorState(), ptr);
+    }
+
+    const_iterator MakeIterator(const T* ptr) const noexcept {
+        return const_iterator(GetIteratorState(), ptr);
+    }
+
+    // Индекс позиции pos, которая должна быть действительным итератором этого вектора
+    size_t IndexOf(const_iterator pos) const noexcept {
+        if (pos.state_ != GetIteratorState()) {
+            vector_detail::DebugFailure("iterator does not belong to this vector");
+        }
+        pos.Check(false);
+        return static_cast<size_t>(pos.ptr_ - data_.GetAddress());
+    }
+
+    // Делает недействительными все итераторы вектора
+    void InvalidateIterators() noexcept {
+        if (iterator_state_ != nullptr) {
+            ++iterator_state_->generation;
+        }
+    }
+#else
+    static constexpr iterator MakeIterator(T* ptr) noexcept {
+        return ptr;
+    }
+
+    static constexpr const_iterator MakeIterator(const T* ptr) noexcept {
+        return ptr;
+    }
+
+    constexpr size_t IndexOf(const_iterator pos) const noexcept {
+        return static_cast<size_t>(pos - cbegin());
+    }
+
+    constexpr void InvalidateIterators() noexcept {
+    }
+#endif
+
+    // Вставляет элемент в позицию index. Итераторы становятся недействительными,
+    // если буфер перевыделен или элементы сдвинуты
     template <typename... Args>
-    void InsertInPlace(size_t index, Args&&... args) {
-        if (index == size_) {
-            new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
+    constexpr void EmplaceAt(size_t index, const std::source_location& site, Args&&... args) {
+        if (size_ == Capacity() || index == Capacity()) {
+            InsertWithReallocate(index, site, std::forward<Args>(args)...);
+        } else {
+            vector_detail::InsertInPlace(data_.GetAddress(), size_, index, std::forward<Args>(args)...);
+            if (index != size_) {
+                InvalidateIterators();
+            }
+        }
+        ++size_;
+    }
+
+    // Присваивает вектору count элементов, начиная с first, переиспользуя
+    // уже сконструированные элементы и имеющуюся память
+    template <typename InputIt>
+    constexpr void AssignElements(InputIt first, size_t count) {
+        if constexpr (std::is_trivially_copyable_v<T> && std::is_pointer_v<InputIt>) {
+            // Во время компиляции memcpy недоступен, и элементы присваиваются общим способом
+            if (!std::is_constant_evaluated()) {
+                if (count > data_.Capacity()) {
+                    // Бросить исключение может только выделение памяти, поэтому старый буфер
+                    // освобождается до копирования: страницы нового буфера занимаются
+                    // уже после того, как возвращены страницы старого
+                    Storage new_data(count, data_.GetAllocator());
+                    data_.Swap(new_data);
+                }
+                if (count != 0) {
+                    std::memcpy(static_cast<void*>(data_.GetAddress()), first, count * sizeof(T));
+                }
+                size_ = count;
+                InvalidateIterators();
+                return;
+            }
+        }
+        if (count > data_.Capacity()) {
+            Storage new_data(count, data_.GetAllocator());
+            vector_detail::UninitializedCopyN(first, count, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
         } else {
-            T temp (std::forward<Args>(args)...);
-            new (data_.GetAddress() + size_) T(std::move(*(begin() + size_ -  1)));
-            std::move_backward(begin() + index, end() - 1, begin() + size_);
-            *(begin() + index) = std::move(temp);
+            const size_t common = std::min(count, size_);
+            std::copy_n(first, common, data_.GetAddress());
+            vector_detail::UninitializedCopyN(
+                std::next(first, common),
+                count - common,
+                data_.GetAddress() + common);
+            if (count < size_) {
+                std::destroy_n(data_.GetAddress() + count, size_ - count);
+            }
         }
+        size_ = count;
+        InvalidateIterators();
     }
 
-    template <typename Pointer>
-    void MoveItemsInNewMemory(Pointer from, Pointer to, size_t count) {
-        // Конструируем элементы в new_data, копируя/перемещая их из data_
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(from, count, to);
+    // Вставляет count элементов из first в позицию index
+    template <typename ForwardIt>
+    constexpr void InsertRange(size_t index, ForwardIt first, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (size_ + count > Capacity()) {
+            const size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + count, sizeof(T));
+            Stats::OnReallocate(Capacity(), new_capacity);
+            if constexpr (CAN_REALLOCATE) {
+                data_.Reallocate(new_capacity);
+                vector_detail::InsertRangeInPlace(data_.GetAddress(), size_, index, first, count);
+            } else {
+                Storage new_data(new_capacity, data_.GetAllocator());
+                vector_detail::InsertRangeInNewMemory<Stats>(data_.GetAddress(), size_, new_data.GetAddress(), index,
+                    first, count);
+                data_.Swap(new_data);
+            }
+            InvalidateIterators();
         } else {
-            std::uninitialized_copy_n(from, count, to);
+            vector_detail::InsertRangeInPlace(data_.GetAddress(), size_, index, first, count);
+            if (index != size_) {
+                InvalidateIterators();
+            }
         }
-        // Разрушаем элементы в data_
-        std::destroy_n(from, count);
+        size_ += count;
+    }
+
+    // Разрушает элементы и освобождает память, оставляя вектор пустым
+    constexpr void ReleaseStorage() noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        Storage empty(data_.GetAllocator());
+        data_.Swap(empty);
+        InvalidateIterators();
+    }
+
+    static size_t Workers(ParallelTag policy, size_t count) noexcept {
+        return vector_detail::ParallelWorkers(policy.threads, count);
+    }
+    
+    template <typename... Args>
+    constexpr void InsertWithReallocate(size_t index, const std::source_location& site, Args&&... args) {
+        const size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T));
+        Stats::OnReallocate(Capacity(), new_capacity);
+        Stats::OnGrowth(size_, new_capacity, site);
+        if constexpr (CAN_REALLOCATE) {
+            // Аргументы могут ссылаться на элементы вектора, а блок при расширении может
+            // переехать, поэтому элемент создаётся до Reallocate
+            alignas(T) std::byte temp[sizeof(T)];
+            T* item = new (temp) T(std::forward<Args>(args)...);
+            try {
+                data_.Reallocate(new_capacity);
+            } catch (...) {
+                std::destroy_at(item);
+                throw;
+            }
+            vector_detail::PlaceRelocated(data_.GetAddress(), size_, index, temp);
+        } else {
+            Storage new_data(new_capacity, data_.GetAllocator());
+            vector_detail::InsertInNewMemory<Stats>(data_.GetAddress(), size_, new_data.GetAddress(), index,
+                std::forward<Args>(args)...);
+            data_.Swap(new_data);
+        }
+        InvalidateIterators();
     }
 };
+
+// Копирует первые N элементов вектора в std::array. Вектор, построенный во время
+// компиляции, нельзя сохранить в constexpr переменной, а массив — можно:
+//     constexpr auto TABLE = ToArray<BuildTable().Size()>(BuildTable());
+template <size_t N, typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+constexpr std::array<T, N> ToArray(const Vector<T, Allocator, GrowthPolicy, Stats>& items) {
+    assert(N <= items.Size());
+    std::array<T, N> result{};
+    std::copy_n(items.GetAddress(), N, result.begin());
+    return result;
+}
+
+namespace pmr {
+
+// Вектор, память под элементы которого выделяется из std::pmr::memory_resource,
+// например из std::pmr::monotonic_buffer_resource
+template <typename T>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
@@ -0,0 +1,423 @@
+#pragma once
+#include "vector.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <variant>
+
+// Двоичная запись и чтение векторов в файловый дескриптор или поток.
+// Формат: заголовок (сигнатура, размер элемента, число элементов), за которым следуют
+// элементы. Тривиально копируемые элементы записываются одним блоком байтов и читаются
+// прямо в буфер вектора. Прочие элементы записываются точкой настройки VectorSerializer
+// в кадры до CHUNK_BYTES байт, перед каждым кадром записывается его длина, поэтому
+// чтение никогда не забирает из источника данные за концом вектора.
+// Порядок байт и размеры типов не преобразуются: формат предназначен для контрольных
+// точек на той же платформе
+
+// Буфер, в который VectorSerializer записывает элемент
+class VectorWriter {
+public:
+    void Write(const void* data, size_t bytes) {
+        if (bytes != 0) {
+            std::memcpy(buffer_.AppendUninitialized(bytes).data(), data, bytes);
+        }
+    }
+
+    template <typename U>
+    void WriteValue(const U& value) {
+        static_assert(std::is_trivially_copyable_v<U>);
+        Write(&value, sizeof(U));
+    }
+
+    size_t Size() const noexcept {
+        return buffer_.Size();
+    }
+
+    const std::byte* GetAddress() const noexcept {
+        return buffer_.GetAddress();
+    }
+
+    void Clear() noexcept {
+        buffer_.Clear();
+    }
+
+private:
+    Vector<std::byte> buffer_;
+};
+
+// Кадр, из которого VectorSerializer читает элемент. При попытке прочитать данные
+// за концом кадра бросается исключение std::runtime_error
+class VectorReader {
+public:
+    VectorReader() = default;
+
+    explicit VectorReader(std::span<const std::byte> data) noexcept
+        : data_(data) {
+    }
+
+    void Read(void* data, size_t bytes) {
+        if (bytes > data_.size() - offset_) {
+            throw std::runtime_error("VectorReader: element is truncated");
+        }
+        if (bytes != 0) {
+            std::memcpy(data, data_.data() + offset_, bytes);
+        }
+        offset_ += bytes;
+    }
+
+    template <typename U>
+    U ReadValue() {
+        static_assert(std::is_trivially_copyable_v<U>);
+        U value;
+        Read(&value, sizeof(U));
+        return value;
+    }
+
+    bool AtEnd() const noexcept {
+        return offset_ == data_.size();
+    }
+
+private:
+    std::span<const std::byte> data_;
+    size_t offset_ = 0;
+};
+
+// Точка настройки записи элементов, которые нельзя копировать побайтово. Специализация
+// должна предоставлять функции
+//     static void Write(VectorWriter& out, const T& item);
+//     static T Read(VectorReader& in);
+template <typename T>
+struct VectorSerializer {};
+
+template <>
+struct VectorSerializer<std::string> {
+    static void Write(VectorWriter& out, const std::string& item) {
+        out.WriteValue<uint64_t>(item.size());
+        out.Write(item.data(), item.size());
+    }
+
+    static std::string Read(VectorReader& in) {
+        std::string item(static_cast<size_t>(in.ReadValue<uint64_t>()), '\0');
+        in.Read(item.data(), item.size());
+        return item;
+    }
+};
+
+template <typename T>
+concept HasVectorSerializer = requires(VectorWriter& out, VectorReader& in, const T& item) {
+    VectorSerializer<T>::Write(out, item);
+    { VectorSerializer<T>::Read(in) } -> std::same_as<T>;
+};
+
+// Элементы, для которых есть VectorSerializer, записываются им, даже если они тривиально копируемы
+template <typename T>
+concept VectorSerializable = HasVectorSerializer<T> || std::is_trivially_copyable_v<T>;
+
+namespace vector_io_detail {
+
+inline constexpr uint64_t MAGIC = 0x31304345564441;  // "ADVEC01"
+inline constexpr size_t CHUNK_BYTES = size_t{1} << 20;
+
+struct Header {
+    uint64_t magic = MAGIC;
+    // Размер элемента для побайтовой записи, 0 для записи кадрами
+    uint64_t element_size = 0;
+    uint64_t count = 0;
+};
+
+template <typename T>
+inline constexpr bool IS_RAW = !HasVectorSerializer<T>;
+
+[[noreturn]] inline void ThrowSystemError(const char* operation) {
+    throw std::system_error(errno, std::generic_category(), std::string("vector_io: ") + operation);
+}
+
+// Приёмник и источник поверх файлового дескриптора. Запись двух блоков выполняется
+// одним вызовом writev, если ядро не примет данные частями
+class FdOutput {
+public:
+    explicit FdOutput(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    void Write(const void* first, size_t first_bytes, const void* second = nullptr, size_t second_bytes = 0) {
+        iovec parts[2] = {{const_cast<void*>(first), first_bytes}, {const_cast<void*>(second), second_bytes}};
+        iovec* part = parts;
+        int part_count = second_bytes != 0 ? 2 : 1;
+        while (part_count > 0) {
+            const ssize_t written = writev(fd_, part, part_count);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ThrowSystemError("writev");
+            }
+            // Пропускаем записанные части
+            size_t rest = static_cast<size_t>(written);
+            while (part_count > 0 && rest >= part->iov_len) {
+                rest -= part->iov_len;
+                ++part;
+                --part_count;
+            }
+            if (part_count > 0) {
+                part->iov_base = static_cast<std::byte*>(part->iov_base) + rest;
+                part->iov_len -= rest;
+            }
+        }
+    }
+
+private:
+    int fd_;
+};
+
+class FdInput {
+public:
+    explicit FdInput(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    void Read(void* data, size_t bytes) {
+        auto* position = static_cast<std::byte*>(data);
+        while (bytes > 0) {
+            const ssize_t received = read(fd_, position, bytes);
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ThrowSystemError("read");
+            }
+            if (received == 0) {
+                throw std::runtime_error("vector_io: unexpected end of file");
+            }
+            position += received;
+            bytes -= static_cast<size_t>(received);
+        }
+    }
+
+private:
+    int fd_;
+};
+
+class StreamOutput {
+public:
+    explicit StreamOutput(std::ostream& out) noexcept
+        : out_(out) {
+    }
+
+    void Write(const void* first, size_t first_bytes, const void* second = nullptr, size_t second_bytes = 0) {
+        out_.write(static_cast<const char*>(first), static_cast<std::streamsize>(first_bytes));
+        if (second_bytes != 0) {
+            out_.write(static_cast<const char*>(second), static_cast<std::streamsize>(second_bytes));
+        }
+        if (!out_) {
+            throw std::runtime_error("vector_io: stream write failed");
+        }
+    }
+
+private:
+    std::ostream& out_;
+};
+
+class StreamInput {
+public:
+    explicit StreamInput(std::istream& in) noexcept
+        : in_(in) {
+    }
+
+    void Read(void* data, size_t bytes) {
+        in_.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if (static_cast<size_t>(in_.gcount()) != bytes) {
+            throw std::runtime_error("vector_io: unexpected end of stream");
+        }
+    }
+
+private:
+    std::istream& in_;
+};
+
+template <typename T, typename Output, typename Allocator, typename GrowthPolicy, typename Stats>
+void WriteVector(Output out, const Vector<T, Allocator, GrowthPolicy, Stats>& items) {
+    static_assert(VectorSerializable<T>, "Specialize VectorSerializer for this type");
+    Header header;
+    header.count = items.Size();
+    if constexpr (IS_RAW<T>) {
+        header.element_size = sizeof(T);
+        out.Write(&header, sizeof(header), items.GetAddress(), items.Size() * sizeof(T));
+    } else {
+        out.Write(&header, sizeof(header));
+        VectorWriter writer;
+        const auto flush = [&] {
+            const uint64_t bytes = writer.Size();
+            out.Write(&bytes, sizeof(bytes), writer.GetAddress(), writer.Size());
+            writer.Clear();
+        };
+        for (const T& item : items) {
+            VectorSerializer<T>::Write(writer, item);
+            if (writer.Size() >= CHUNK_BYTES) {
+                flush();
+            }
+        }
+        if (writer.Size() != 0) {
+            flush();
+        }
+    }
+}
+
+template <typename T, typename Input>
+uint64_t ReadHeader(Input& in) {
+    Header header;
+    in.Read(&header, sizeof(header));
+    if (header.magic != MAGIC) {
+        throw std::runtime_error("vector_io: not a vector stream");
+    }
+    if (header.element_size != (IS_RAW<T> ? sizeof(T) : 0)) {
+        throw std::runtime_error("vector_io: element type mismatch");
+    }
+    return header.count;
+}
+
+// Читает элементы кадрами, не забирая из источника данных за последним элементом
+template <typename T>
+class FrameReader {
+public:
+    template <typename Input>
+    T Next(Input& in) {
+        if (reader_.AtEnd()) {
+            const auto bytes = static_cast<size_t>(ReadValue<uint64_t>(in));
+            if (bytes == 0) {
+                throw std::runtime_error("vector_io: empty frame");
+            }
+            frame_.ResizeForOverwrite(bytes);
+            in.Read(frame_.GetAddress(), bytes);
+            reader_ = VectorReader(std::span<const std::byte>(frame_.GetAddress(), bytes));
+        }
+        return VectorSerializer<T>::Read(reader_);
+    }
+
+private:
+    template <typename U, typename Input>
+    static U ReadValue(Input& in) {
+        U value;
+        in.Read(&value, sizeof(U));
+        return value;
+    }
+
+    Vector<std::byte> frame_;
+    VectorReader reader_;
+};
+
+template <typename T, typename Input, typename Allocator, typename GrowthPolicy, typename Stats>
+void ReadVector(Input in, Vector<T, Allocator, GrowthPolicy, Stats>& items) {
+    static_assert(VectorSerializable<T>, "Specialize VectorSerializer for this type");
+    const auto count = static_cast<size_t>(ReadHeader<T>(in));
+    items.Clear();
+    try {
+        if constexpr (IS_RAW<T>) {
+            items.ResizeForOverwrite(count);
+            in.Read(items.GetAddress(), count * sizeof(T));
+        } else {
+            items.Reserve(count);
+            FrameReader<T> frames;
+            for (size_t i = 0; i < count; ++i) {
+                items.EmplaceBack(frames.Next(in));
+            }
+        }
+    } catch (...) {
+        items.Clear();
+        throw;
+    }
+}
+
+}  // namespace vector_io_detail
+
+// Записывает вектор в файловый дескриптор fd. Тривиально копируемые элементы
+// записываются вместе с заголовком одним вызовом writev
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void WriteTo(const Vector<T, Allocator, GrowthPolicy, Stats>& items, int fd) {
+    vector_io_detail::WriteVector(vector_io_detail::FdOutput(fd), items);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void WriteTo(const Vector<T, Allocator, GrowthPolicy, Stats>& items, std::ostream& out) {
+    vector_io_detail::WriteVector(vector_io_detail::StreamOutput(out), items);
+}
+
+// Заменяет содержимое items прочитанным из fd вектором. Вместимость резервируется
+// один раз по заголовку, тривиально копируемые элементы читаются прямо в буфер вектора.
+// При ошибке items остаётся пустым
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void ReadFrom(Vector<T, Allocator, GrowthPolicy, Stats>& items, int fd) {
+    vector_io_detail::ReadVector(vector_io_detail::FdInput(fd), items);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Stats>
+void ReadFrom(Vector<T, Allocator, GrowthPolicy, Stats>& items, std::istream& in) {
+    vector_io_detail::ReadVector(vector_io_detail::StreamInput(in), items);
+}
+
+// Читает записанный WriteTo вектор частями, не загружая его в память целиком:
+//     VectorChunkReader<Record> reader(fd);
+//     Vector<Record> chunk;
+//     while (reader.ReadChunk(chunk, 1 << 16) != 0) { ... }
+template <typename T>
+class VectorChunkReader {
+    static_assert(VectorSerializable<T>, "Specialize VectorSerializer for this type");
+
+public:
+    explicit VectorChunkReader(int fd)
+        : input_(vector_io_detail::FdInput(fd)) {
+        ReadHeader();
+    }
+
+    explicit VectorChunkReader(std::istream& in)
+        : input_(vector_io_detail::StreamInput(in)) {
+        ReadHeader();
+    }
+
+    // Число ещё не прочитанных элементов
+    size_t Remaining() const noexcept {
+        return remaining_;
+    }
+
+    // Заменяет содержимое chunk следующими не более чем max_count элементами
+    // и возвращает их число. В конце данных возвращает 0. После исключения
+    // положение в источнике не определено и чтение продолжать нельзя
+    template <typename Allocator, typename GrowthPolicy, typename Stats>
+    size_t ReadChunk(Vector<T, Allocator, GrowthPolicy, Stats>& chunk, size_t max_count) {
+        const size_t count = std::min(max_count, remaining_);
+        chunk.Clear();
+        std::visit([&](auto& in) {
+            if constexpr (vector_io_detail::IS_RAW<T>) {
+                chunk.ResizeForOverwrite(count);
+                in.Read(chunk.GetAddress(), count * sizeof(T));
+            } else {
+                chunk.Reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    chunk.EmplaceBack(frames_.Next(in));
+                }
+            }
+        }, input_);
+        remaining_ -= count;
+        return count;
+    }
+
+private:
+    void ReadHeader() {
+        remaining_ = std::visit([](auto& in) {
+            return static_cast<size_t>(vector_io_detail::ReadHeader<T>(in));
+        }, input_);
+    }
+
+    std::variant<vector_io_detail::FdInput, vector_io_detail::StreamInput> input_;
+    vector_io_detail::FrameReader<T> frames_;
+    size_t remaining_ = 0;
+};
@@ -0,0 +1,474 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <limits>
+
+// Поэлементные алгоритмы над векторами чисел (Fill, Find, Count, Contains, Sum, MinMax,
+// Compare), выполняемые SIMD-инструкциями. Ширина регистров выбирается при первом вызове
+// по возможностям процессора: 16 байт (SSE2), 32 (AVX2) или 64 (AVX-512BW). Ядра написаны
+// на векторных расширениях GCC/Clang и компилируются под каждый набор инструкций
+// атрибутом target, поэтому от флагов сборки не зависят.
+// Если аллокатор выравнивает буфер по ширине регистра (AlignedAllocator<T, 64>), загрузки
+// выполняются выровненными. Если вместимость вектора покрывает последний регистр целиком,
+// хвост обрабатывается тем же регистром с маской вместо скалярного цикла, а Fill
+// записывает значение и в неиспользуемую часть буфера
+
+// Типы элементов, для которых есть SIMD-ядра
+template <typename T>
+concept SimdArithmetic = (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Ширина SIMD-регистров, которой пользуются алгоритмы
+enum class SimdLevel {
+    // 16-байтные векторы: SSE2 на x86-64, базовый набор на других архитектурах
+    SSE2,
+    AVX2,
+    AVX512,
+};
+
+namespace vector_simd_detail {
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::SSE2;
+}
+
+inline std::atomic<SimdLevel>& CurrentLevel() noexcept {
+    static std::atomic<SimdLevel> level{DetectSimdLevel()};
+    return level;
+}
+
+// Выравнивание буфера, которое гарантирует аллокатор
+template <typename Allocator, typename = void>
+struct AllocatorAlignment
+    : std::integral_constant<size_t, alignof(typename std::allocator_traits<Allocator>::value_type)> {};
+
+template <typename Allocator>
+struct AllocatorAlignment<Allocator, std::void_t<decltype(Allocator::ALIGNMENT)>>
+    : std::integral_constant<size_t, Allocator::ALIGNMENT> {};
+
+template <typename T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, T,
+    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+// Ядра для регистров шириной Width байт. Все функции встраиваются в вызывающую функцию
+// с атрибутом target и компилируются под её набор инструкций. Векторы передаются только
+// по ссылке, чтобы не зависеть от соглашения о вызовах для широких регистров.
+// capacity — число элементов, доступных в буфере за data; последний регистр читается
+// или записывается целиком, только если он помещается в capacity
+template <typename T, size_t Width, size_t Alignment>
+struct Kernels {
+    static constexpr size_t LANES = Width / sizeof(T);
+    static constexpr bool ALIGNED = Alignment >= Width;
+
+    using Lane = std::conditional_t<sizeof(T) == 1, int8_t,
+        std::conditional_t<sizeof(T) == 2, int16_t, std::conditional_t<sizeof(T) == 4, int32_t, int64_t>>>;
+    using ULane = std::make_unsigned_t<Lane>;
+    using Wide = SumType<T>;
+
+    typedef T V __attribute__((vector_size(Width)));
+    // Маска сравнения: -1 в совпавших позициях, 0 в остальных
+    typedef Lane M __attribute__((vector_size(Width)));
+    typedef ULane U __attribute__((vector_size(Width)));
+    // Тип слова зависит от параметров шаблона, иначе GCC не применяет к нему vector_size
+    using Word = std::conditional_t<sizeof(T) != 0, uint64_t, T>;
+    typedef Word Words __attribute__((vector_size(Width)));
+    typedef Wide W __attribute__((vector_size(LANES * sizeof(Wide))));
+
+    [[gnu::always_inline]] static void Load(V& out, const T* p) noexcept {
+        if constexpr (ALIGNED) {
+            p = static_cast<const T*>(__builtin_assume_aligned(p, Width));
+        }
+        std::memcpy(&out, p, Width);
+    }
+
+    [[gnu::always_inline]] static void Store(T* p, const V& value) noexcept {
+        if constexpr (ALIGNED) {
+            p = static_cast<T*>(__builtin_assume_aligned(p, Width));
+        }
+        std::memcpy(p, &value, Width);
+    }
+
+    [[gnu::always_inline]] static bool Any(const M& mask) noexcept {
+        Words words;
+        std::memcpy(&words, &mask, Width);
+        uint64_t result = 0;
+        for (size_t i = 0; i < Width / sizeof(Word); ++i) {
+            result |= words[i];
+        }
+        return result != 0;
+    }
+
+    // Маска первых count позиций регистра
+    [[gnu::always_inline]] static void Prefix(M& out, size_t count) noexcept {
+        M index;
+        for (size_t i = 0; i < LANES; ++i) {
+            index[i] = static_cast<Lane>(i);
+        }
+        out = index < static_cast<Lane>(count);
+    }
+
+    // Можно ли обработать хвост из rest элементов, начинающийся с позиции i, целым регистром
+    [[gnu::always_inline]] static bool PaddedTail(size_t i, size_t rest, size_t capacity) noexcept {
+        return rest != 0 && i + LANES <= capacity;
+    }
+
+    [[gnu::always_inline]] static void Fill(T* data, size_t size, size_t capacity, T value) noexcept {
+        const V splat = V{} + value;
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES) {
+            Store(data + i, splat);
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Store(data + i, splat);
+            return;
+        }
+        for (; i < size; ++i) {
+            data[i] = value;
+        }
+    }
+
+    // Индекс первого элемента, равного value, или size
+    [[gnu::always_inline]] static size_t Find(const T* data, size_t size, size_t capacity, T value) noexcept {
+        const V splat = V{} + value;
+        size_t i = 0;
+        V chunk;
+        for (; i + LANES <= size; i += LANES) {
+            Load(chunk, data + i);
+            const M equal = chunk == splat;
+            if (Any(equal)) {
+                return i + FirstLane(equal);
+            }
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Load(chunk, data + i);
+            M valid;
+            Prefix(valid, size - i);
+            const M equal = (chunk == splat) & valid;
+            return Any(equal) ? i + FirstLane(equal) : size;
+        }
+        for (; i < size; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return size;
+    }
+
+    [[gnu::always_inline]] static size_t Count(const T* data, size_t size, size_t capacity, T value) noexcept {
+        // Счётчики в позициях регистра имеют ширину элемента и сбрасываются в total,
+        // пока не переполнились
+        constexpr size_t FLUSH_PERIOD = std::min<size_t>(std::numeric_limits<ULane>::max(), size_t{1} << 30);
+        const V splat = V{} + value;
+        size_t total = 0;
+        size_t i = 0;
+        V chunk;
+        while (i + LANES <= size) {
+            U counters{};
+            for (size_t step = 0; step < FLUSH_PERIOD && i + LANES <= size; ++step, i += LANES) {
+                Load(chunk, data + i);
+                counters -= reinterpret_cast<U>(chunk == splat);
+            }
+            total += SumLanes(counters);
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Load(chunk, data + i);
+            M valid;
+            Prefix(valid, size - i);
+            U counters{};
+            counters -= reinterpret_cast<U>((chunk == splat) & valid);
+            return total + SumLanes(counters);
+        }
+        for (; i < size; ++i) {
+            total += data[i] == value;
+        }
+        return total;
+    }
+
+    [[gnu::always_inline]] static Wide Sum(const T* data, size_t size, size_t capacity) noexcept {
+        W sums{};
+        size_t i = 0;
+        V chunk;
+        for (; i + LANES <= size; i += LANES) {
+            Load(chunk, data + i);
+            sums += __builtin_convertvector(chunk, W);
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Load(chunk, data + i);
+            M valid;
+            Prefix(valid, size - i);
+            chunk = valid ? chunk : V{};
+            sums += __builtin_convertvector(chunk, W);
+            i = size;
+        }
+        Wide total{};
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            total += sums[lane];
+        }
+        for (; i < size; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+
+    // size должен быть больше нуля
+    [[gnu::always_inline]] static std::pair<T, T> MinMax(const T* data, size_t size, size_t capacity) noexcept {
+        const V first = V{} + data[0];
+        V low = first;
+        V high = first;
+        size_t i = 0;
+        V chunk;
+        for (; i + LANES <= size; i += LANES) {
+            Load(chunk, data + i);
+            low = chunk < low ? chunk : low;
+            high = high < chunk ? chunk : high;
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Load(chunk, data + i);
+            M valid;
+            Prefix(valid, size - i);
+            // Позиции за концом заменяются первым элементом, который не меняет результат
+            chunk = valid ? chunk : first;
+            low = chunk < low ? chunk : low;
+            high = high < chunk ? chunk : high;
+            i = size;
+        }
+        T min = low[0];
+        T max = high[0];
+        for (size_t lane = 1; lane < LANES; ++lane) {
+            min = low[lane] < min ? low[lane] : min;
+            max = max < high[lane] ? high[lane] : max;
+        }
+        for (; i < size; ++i) {
+            min = data[i] < min ? data[i] : min;
+            max = max < data[i] ? data[i] : max;
+        }
+        return {min, max};
+    }
+
+    // Индекс первой позиции, где lhs[i] != rhs[i], или size
+    [[gnu::always_inline]] static size_t Mismatch(const T* lhs, const T* rhs, size_t size, size_t capacity) noexcept {
+        size_t i = 0;
+        V left;
+        V right;
+        for (; i + LANES <= size; i += LANES) {
+            Load(left, lhs + i);
+            Load(right, rhs + i);
+            const M different = left != right;
+            if (Any(different)) {
+                return i + FirstLane(different);
+            }
+        }
+        if (PaddedTail(i, size - i, capacity)) {
+            Load(left, lhs + i);
+            Load(right, rhs + i);
+            M valid;
+            Prefix(valid, size - i);
+            const M different = (left != right) & valid;
+            return Any(different) ? i + FirstLane(different) : size;
+        }
+        for (; i < size; ++i) {
+            if (lhs[i] != rhs[i]) {
+                return i;
+            }
+        }
+        return size;
+    }
+
+private:
+    [[gnu::always_inline]] static size_t FirstLane(const M& mask) noexcept {
+        size_t lane = 0;
+        while (mask[lane] == 0) {
+            ++lane;
+        }
+        return lane;
+    }
+
+    [[gnu::always_inline]] static size_t SumLanes(const U& counters) noexcept {
+        size_t total = 0;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            total += counters[lane];
+        }
+        return total;
+    }
+};
+
+// Операции, передаваемые в Run: Op::Apply<Width>(args...) вызывает нужное ядро
+template <typename T, size_t Alignment>
+struct Ops {
+    struct Fill {
+        template <size_t Width>
+        [[gnu::always_inline]] static void Apply(T* data, size_t size, size_t capacity, T value) noexcept {
+            Kernels<T, Width, Alignment>::Fill(data, size, capacity, value);
+        }
+    };
+
+    struct Find {
+        template <size_t Width>
+        [[gnu::always_inline]] static size_t Apply(const T* data, size_t size, size_t capacity, T value) noexcept {
+            return Kernels<T, Width, Alignment>::Find(data, size, capacity, value);
+        }
+    };
+
+    struct Count {
+        template <size_t Width>
+        [[gnu::always_inline]] static size_t Apply(const T* data, size_t size, size_t capacity, T value) noexcept {
+            return Kernels<T, Width, Alignment>::Count(data, size, capacity, value);
+        }
+    };
+
+    struct Sum {
+        template <size_t Width>
+        [[gnu::always_inline]] static SumType<T> Apply(const T* data, size_t size, size_t capacity) noexcept {
+            return Kernels<T, Width, Alignment>::Sum(data, size, capacity);
+        }
+    };
+
+    struct MinMax {
+        template <size_t Width>
+        [[gnu::always_inline]] static std::pair<T, T> Apply(const T* data, size_t size, size_t capacity) noexcept {
+            return Kernels<T, Width, Alignment>::MinMax(data, size, capacity);
+        }
+    };
+
+    struct Mismatch {
+        template <size_t Width>
+        [[gnu::always_inline]] static size_t Apply(const T* lhs, const T* rhs, size_t size,
+            size_t capacity) noexcept {
+            return Kernels<T, Width, Alignment>::Mismatch(lhs, rhs, size, capacity);
+        }
+    };
+};
+
+template <typename Op, typename... Args>
+auto RunSse2(Args... args) noexcept {
+    return Op::template Apply<16>(args...);
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+template <typename Op, typename... Args>
+[[gnu::target("avx2")]] auto RunAvx2(Args... args) noexcept {
+    return Op::template Apply<32>(args...);
+}
+
+template <typename Op, typename... Args>
+[[gnu::target("avx512f,avx512bw")]] auto RunAvx512(Args... args) noexcept {
+    return Op::template Apply<64>(args...);
+}
+#endif
+
+// Вызывает операцию с регистрами наибольшей доступной ширины
+template <typename Op, typename... Args>
+auto Run(Args... args) noexcept {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    switch (CurrentLevel().load(std::memory_order_relaxed)) {
+        case SimdLevel::AVX512:
+            return RunAvx512<Op>(args...);
+        case SimdLevel::AVX2:
+            return RunAvx2<Op>(args...);
+        case SimdLevel::SSE2:
+            break;
+    }
+#endif
+    return RunSse2<Op>(args...);
+}
+
+template <typename T, typename Allocator>
+using VectorOps = Ops<T, AllocatorAlignment<Allocator>::value>;
+
+}  // namespace vector_simd_detail
+
+// Наибольшая ширина регистров, которую поддерживает процессор
+inline SimdLevel SupportedSimdLevel() noexcept {
+    static const SimdLevel level = vector_simd_detail::DetectSimdLevel();
+    return level;
+}
+
+// Ширина регистров, которой сейчас пользуются алгоритмы
+inline SimdLevel ActiveSimdLevel() noexcept {
+    return vector_simd_detail::CurrentLevel().load(std::memory_order_relaxed);
+}
+
+// Ограничивает ширину регистров (например, чтобы сравнить ядра в тестах или избежать
+// снижения частоты на AVX-512). Уровни выше поддерживаемого процессором игнорируются
+inline void LimitSimdLevel(SimdLevel level) noexcept {
+    vector_simd_detail::CurrentLevel().store(std::min(level, SupportedSimdLevel()), std::memory_order_relaxed);
+}
+
+// Присваивает value всем элементам
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+void Fill(Vector<T, Allocator, GrowthPolicy, Stats>& v, T value) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Fill;
+    vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity(), value);
+}
+
+// Первый элемент, равный value, или end()
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename Vector<T, Allocator, GrowthPolicy, Stats>::const_iterator Find(
+    const Vector<T, Allocator, GrowthPolicy, Stats>& v, T value) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Find;
+    return v.begin() + vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity(), value);
+}
+
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+typename Vector<T, Allocator, GrowthPolicy, Stats>::iterator Find(
+    Vector<T, Allocator, GrowthPolicy, Stats>& v, T value) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Find;
+    return v.begin() + vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity(), value);
+}
+
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+bool Contains(const Vector<T, Allocator, GrowthPolicy, Stats>& v, T value) noexcept {
+    return Find(v, value) != v.end();
+}
+
+// Число элементов, равных value
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+size_t Count(const Vector<T, Allocator, GrowthPolicy, Stats>& v, T value) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Count;
+    return vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity(), value);
+}
+
+// Сумма элементов. Целые числа суммируются в 64-битных (int64_t или uint64_t) счётчиках.
+// Числа с плавающей точкой суммируются в типе T по позициям регистра, поэтому результат
+// может отличаться от последовательного сложения в пределах погрешности округления
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+vector_simd_detail::SumType<T> Sum(const Vector<T, Allocator, GrowthPolicy, Stats>& v) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Sum;
+    return vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity());
+}
+
+// Наименьший и наибольший элементы непустого вектора. Если среди чисел с плавающей
+// точкой есть NaN, результат не определён
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::pair<T, T> MinMax(const Vector<T, Allocator, GrowthPolicy, Stats>& v) noexcept {
+    assert(v.Size() > 0);
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::MinMax;
+    return vector_simd_detail::Run<Op>(v.GetAddress(), v.Size(), v.Capacity());
+}
+
+// Лексикографическое сравнение, равносильное std::lexicographical_compare_three_way
+template <SimdArithmetic T, typename Allocator, typename GrowthPolicy, typename Stats>
+std::compare_three_way_result_t<T> Compare(const Vector<T, Allocator, GrowthPolicy, Stats>& lhs,
+    const Vector<T, Allocator, GrowthPolicy, Stats>& rhs) noexcept {
+    using Op = typename vector_simd_detail::VectorOps<T, Allocator>::Mismatch;
+    const size_t size = std::min(lhs.Size(), rhs.Size());
+    // Хвост можно читать целым регистром, только если он помещается в оба буфера
+    const size_t capacity = std::min(lhs.Capacity(), rhs.Capacity());
+    const size_t index = vector_simd_detail::Run<Op>(lhs.GetAddress(), rhs.GetAddress(), size, capacity);
+    if (index != size) {
+        return lhs[index] <=> rhs[index];
+    }
+    return lhs.Size() <=> rhs.Size();
+}
@@ -0,0 +1,290 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Счётчики событий памяти группы векторов. Обновляются атомарно, поэтому
+// векторы одной группы могут жить в разных потоках
+struct VectorStats {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> bytes_deallocated{0};
+    std::atomic<uint64_t> reallocations{0};
+    std::atomic<uint64_t> elements_moved{0};
+    std::atomic<uint64_t> elements_copied{0};
+    std::atomic<uint64_t> peak_capacity{0};
+};
+
+// Значения счётчиков группы на момент опроса реестра
+struct VectorStatsSample {
+    std::string name;
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_deallocated = 0;
+    uint64_t reallocations = 0;
+    uint64_t elements_moved = 0;
+    uint64_t elements_copied = 0;
+    uint64_t peak_capacity = 0;
+};
+
+// Глобальный реестр групп статистики. Группа регистрируется при первом событии
+// её векторов, опрос возвращает значения счётчиков всех групп
+class VectorStatsRegistry {
+public:
+    static VectorStatsRegistry& Instance() {
+        static VectorStatsRegistry registry;
+        return registry;
+    }
+
+    void Register(std::string_view name, const VectorStats* stats) {
+        std::lock_guard guard(mutex_);
+        entries_.push_back({std::string(name), stats});
+    }
+
+    std::vector<VectorStatsSample> Sample() const {
+        std::lock_guard guard(mutex_);
+        std::vector<VectorStatsSample> result;
+        result.reserve(entries_.size());
+        for (const auto& [name, stats] : entries_) {
+            result.push_back({
+                name,
+                stats->allocations.load(std::memory_order_relaxed),
+                stats->deallocations.load(std::memory_order_relaxed),
+                stats->bytes_allocated.load(std::memory_order_relaxed),
+                stats->bytes_deallocated.load(std::memory_order_relaxed),
+                stats->reallocations.load(std::memory_order_relaxed),
+                stats->elements_moved.load(std::memory_order_relaxed),
+                stats->elements_copied.load(std::memory_order_relaxed),
+                stats->peak_capacity.load(std::memory_order_relaxed),
+            });
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        const VectorStats* stats;
+    };
+
+    VectorStatsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+// Группа статистики по умолчанию
+struct DefaultStatsTag {
+    static constexpr std::string_view NAME = "default";
+};
+
+// Политика, собирающая статистику в группу Tag. Tag::NAME задаёт имя группы в реестре,
+// что позволяет разделять векторы разных мест вызова:
+//     struct ParserTag { static constexpr std::string_view NAME = "parser"; };
+//     Vector<Token, std::allocator<Token>, DoublingGrowth, CountingStats<ParserTag>> tokens;
+template <typename Tag = DefaultStatsTag>
+struct CountingStats {
+    static void OnAllocate(size_t capacity, size_t bytes) noexcept {
+        VectorStats& stats = Get();
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        stats.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        uint64_t peak = stats.peak_capacity.load(std::memory_order_relaxed);
+        while (peak < capacity
+               && !stats.peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void OnDeallocate(size_t bytes) noexcept {
+        VectorStats& stats = Get();
+        stats.deallocations.fetch_add(1, std::memory_order_relaxed);
+        stats.bytes_deallocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void OnReallocate(size_t /*old_capacity*/, size_t /*new_capacity*/) noexcept {
+        Get().reallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void OnRelocate(size_t moved, size_t copied) noexcept {
+        VectorStats& stats = Get();
+        stats.elements_moved.fetch_add(moved, std::memory_order_relaxed);
+        stats.elements_copied.fetch_add(copied, std::memory_order_relaxed);
+    }
+
+    static void OnGrowth(size_t /*size*/, size_t /*new_capacity*/, const std::source_location& /*site*/) noexcept {
+    }
+
+    static VectorStats& Get() noexcept {
+        static VectorStats& stats = Register();
+        return stats;
+    }
+
+private:
+    static VectorStats& Register() noexcept {
+        static VectorStats stats;
+        try {
+            VectorStatsRegistry::Instance().Register(Tag::NAME, &stats);
+        } catch (...) {
+            // Группа, которую не удалось зарегистрировать, продолжает считать события,
+            // но не попадает в опрос реестра
+        }
+        return stats;
+    }
+};
+
+// Гистограмма перевыделений, вызванных вставкой, для одного места вызова
+struct GrowthSiteSample {
+    std::string name;
+    std::string file;
+    std::string function;
+    uint32_t line = 0;
+    uint32_t column = 0;
+    // Число попавших в выборку событий и оценка общего числа событий с учётом частоты выборки
+    uint64_t samples = 0;
+    uint64_t estimated_events = 0;
+    // Наибольший размер вектора в момент перевыделения: Reserve(max_size + 1) в этом месте
+    // устранил бы все попавшие в выборку перевыделения
+    uint64_t max_size = 0;
+    // size_buckets[k] — число событий, при которых размер вектора был в [2^(k-1), 2^k),
+    // size_buckets[0] — события с пустым вектором
+    std::array<uint64_t, 65> size_buckets{};
+};
+
+// Глобальный реестр мест вызова, в которых вставка вызвала перевыделение буфера.
+// Заполняется политикой SamplingStats
+class GrowthSiteRegistry {
+public:
+    static GrowthSiteRegistry& Instance() {
+        static GrowthSiteRegistry registry;
+        return registry;
+    }
+
+    void Record(std::string_view name, size_t sample_rate, const std::source_location& site, size_t size) {
+        std::lock_guard guard(mutex_);
+        Entry& entry = entries_[Key{name, site.file_name(), site.function_name(), site.line(), site.column()}];
+        entry.sample_rate = sample_rate;
+        ++entry.samples;
+        entry.max_size = std::max<uint64_t>(entry.max_size, size);
+        ++entry.size_buckets[std::bit_width(size)];
+    }
+
+    // Места вызова в порядке убывания числа событий
+    std::vector<GrowthSiteSample> Sample() const {
+        std::vector<GrowthSiteSample> result;
+        {
+            std::lock_guard guard(mutex_);
+            result.reserve(entries_.size());
+            for (const auto& [key, entry] : entries_) {
+                result.push_back({
+                    std::string(key.name),
+                    std::string(key.file),
+                    std::string(key.function),
+                    key.line,
+                    key.column,
+                    entry.samples,
+                    entry.samples * entry.sample_rate,
+                    entry.max_size,
+                    entry.size_buckets,
+                });
+            }
+        }
+        std::stable_sort(result.begin(), result.end(), [](const GrowthSiteSample& lhs, const GrowthSiteSample& rhs) {
+            return lhs.estimated_events > rhs.estimated_events;
+        });
+        return result;
+    }
+
+    // Выводит гистограммы в текстовом виде:
+    //     parser src/lexer.cpp:42 samples=12 events~12000 max_size=8191
+    //         [1024, 2048) 5
+    //         [4096, 8192) 7
+    void Write(std::ostream& out) const {
+        for (const GrowthSiteSample& sample : Sample()) {
+            out << sample.name << ' ' << sample.file << ':' << sample.line << ' ' << sample.function
+                << " samples=" << sample.samples << " events~" << sample.estimated_events
+                << " max_size=" << sample.max_size << '\n';
+            for (size_t k = 0; k < sample.size_buckets.size(); ++k) {
+                if (sample.size_buckets[k] == 0) {
+                    continue;
+                }
+                const uint64_t low = k == 0 ? 0 : uint64_t{1} << (k - 1);
+                out << "    [" << low << ", ";
+                if (k == 0) {
+                    out << 1;
+                } else if (k < 64) {
+                    out << (uint64_t{1} << k);
+                } else {
+                    out << "inf";
+                }
+                out << ") " << sample.size_buckets[k] << '\n';
+            }
+        }
+    }
+
+    void Clear() {
+        std::lock_guard guard(mutex_);
+        entries_.clear();
+    }
+
+private:
+    // Имена групп, файлов и функций — строки со статическим временем жизни
+    struct Key {
+        std::string_view name;
+        std::string_view file;
+        std::string_view function;
+        uint32_t line;
+        uint32_t column;
+
+        auto operator<=>(const Key&) const = default;
+    };
+
+    struct Entry {
+        size_t sample_rate = 1;
+        uint64_t samples = 0;
+        uint64_t max_size = 0;
+        std::array<uint64_t, 65> size_buckets{};
+    };
+
+    GrowthSiteRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+};
+
+// Политика, записывающая в GrowthSiteRegistry каждое SampleRate-е перевыделение буфера
+// при вставке в потоке вместе с местом вызова и размером вектора. Остальные события
+// обрабатывает Base. Пропущенное событие стоит уменьшения счётчика потока, поэтому
+// политику можно оставлять включённой в рабочих сборках:
+//     using Stats = SamplingStats<ParserTag, 1000, CountingStats<ParserTag>>;
+//     Vector<Token, std::allocator<Token>, DoublingGrowth, Stats> tokens;
+//     ...
+//     GrowthSiteRegistry::Instance().Write(std::cerr);
+template <typename Tag = DefaultStatsTag, size_t SampleRate = 1000, typename Base = NoStats>
+struct SamplingStats : Base {
+    static_assert(SampleRate > 0);
+
+    static void OnGrowth(size_t size, size_t new_capacity, const std::source_location& site) noexcept {
+        Base::OnGrowth(size, new_capacity, site);
+        thread_local size_t countdown = SampleRate;
+        if (--countdown != 0) {
+            return;
+        }
+        countdown = SampleRate;
+        try {
+            GrowthSiteRegistry::Instance().Record(Tag::NAME, SampleRate, site, size);
+        } catch (...) {
+            // Событие, которое не удалось записать, пропускается
+        }
+    }
+};